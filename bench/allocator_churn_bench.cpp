@@ -0,0 +1,42 @@
+#include <cstddef>
+#include <print>
+#include <string>
+#include <thread>
+#include <vector>
+#include "bench.hpp"
+#include "my/memory.hpp"
+#include "my/thread_cache.hpp"
+#include "my/vector.hpp"
+
+// Every thread repeatedly builds small vectors by push_back and drops them,
+// so that nearly all the time goes into allocate/deallocate.
+template<class Alloc>
+void bench_churn(std::string_view name, std::size_t n_threads, std::size_t rounds) {
+    constexpr std::size_t max_len = 64;
+    bench::run(name, n_threads * rounds, [&] {
+        std::vector<std::thread> threads;
+        for (std::size_t t = 0; t < n_threads; ++t) {
+            threads.emplace_back([rounds] {
+                for (std::size_t r = 0; r < rounds; ++r) {
+                    my::vector<std::size_t, Alloc> v{};
+                    for (std::size_t i = 0; i < r % max_len; ++i) {
+                        v.push_back(i);
+                    }
+                    bench::do_not_optimize(v.data());
+                }
+            });
+        }
+        for (auto& th : threads) {
+            th.join();
+        }
+    });
+}
+
+int main(int argc, char** argv) {
+    std::size_t n_threads = (argc > 1) ? std::stoull(argv[1]) : std::thread::hardware_concurrency();
+    std::size_t rounds = (argc > 2) ? std::stoull(argv[2]) : std::size_t{1} << 18;
+    std::println("push_back/destroy churn, {} threads x {} vectors (ns per vector)", n_threads, rounds);
+
+    bench_churn<my::allocator<std::size_t>>("my::allocator (operator new)", n_threads, rounds);
+    bench_churn<my::thread_cached_allocator<std::size_t>>("my::allocator (thread cache)", n_threads, rounds);
+}
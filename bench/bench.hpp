@@ -0,0 +1,148 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <format>
+#include <new>
+#include <print>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace bench {
+
+// Keeps the optimizer from discarding a value that is never read.
+template<class T>
+inline void do_not_optimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+inline void clobber_memory() {
+    asm volatile("" : : : "memory");
+}
+
+// Calls to the global operator new since the program started. Every bench is
+// a single translation unit, so this header can replace operator new below.
+inline std::atomic<std::size_t> allocation_count{0};
+
+struct result {
+    std::string name;
+    std::size_t ops;
+    double ns_per_op;
+    double allocs_per_op;
+};
+
+// Results of every run() in this process. If the BENCH_JSON environment
+// variable names a file, they are written there as JSON at exit.
+class registry {
+    std::vector<result> m_results;
+
+    registry() = default;
+public:
+    registry(const registry&) = delete;
+    registry& operator=(const registry&) = delete;
+
+    ~registry() {
+        if (const char* path = std::getenv("BENCH_JSON")) {
+            write_json(path);
+        }
+    }
+
+    static registry& instance() {
+        static registry r;
+        return r;
+    }
+
+    void add(result r) {
+        m_results.push_back(std::move(r));
+    }
+
+    const std::vector<result>& results() const noexcept {
+        return m_results;
+    }
+
+    bool write_json(const char* path) const {
+        std::FILE* out = std::fopen(path, "w");
+        if (out == nullptr) {
+            std::println(stderr, "bench: cannot write {}", path);
+            return false;
+        }
+        std::print(out, "[\n");
+        for (std::size_t i = 0; i < m_results.size(); ++i) {
+            const result& r = m_results[i];
+            std::print(out, "  {{\"name\": \"{}\", \"ops\": {}, \"ns_per_op\": {:.3f}, "
+                            "\"allocs_per_op\": {:.3f}}}{}\n",
+                       escape(r.name), r.ops, r.ns_per_op, r.allocs_per_op,
+                       (i + 1 < m_results.size()) ? "," : "");
+        }
+        std::print(out, "]\n");
+        std::fclose(out);
+        return true;
+    }
+
+private:
+    static std::string escape(std::string_view s) {
+        std::string escaped;
+        for (char c : s) {
+            if (c == '"' || c == '\\') {
+                escaped += '\\';
+            }
+            escaped += c;
+        }
+        return escaped;
+    }
+}; // class registry
+
+// Runs fn() `reps` times and reports the fastest run as ns per operation,
+// where one run performs `ops` operations, along with the average number
+// of allocations per operation.
+template<class F>
+double run(std::string_view name, std::size_t ops, F&& fn, int reps = 5) {
+    using clock = std::chrono::steady_clock;
+    double best = 0;
+    std::size_t allocs_before = allocation_count.load(std::memory_order_relaxed);
+    for (int i = 0; i < reps; ++i) {
+        auto start = clock::now();
+        fn();
+        clobber_memory();
+        std::chrono::duration<double, std::nano> elapsed = clock::now() - start;
+        best = (i == 0) ? elapsed.count() : std::min(best, elapsed.count());
+    }
+    std::size_t allocs = allocation_count.load(std::memory_order_relaxed) - allocs_before;
+
+    double n_ops = static_cast<double>(std::max<std::size_t>(ops, 1));
+    double ns_per_op = best / n_ops;
+    double allocs_per_op = static_cast<double>(allocs) / reps / n_ops;
+    std::println("{:<48} {:>12.3f} ns/op {:>10.3f} allocs/op", name, ns_per_op, allocs_per_op);
+    registry::instance().add({ std::string{name}, ops, ns_per_op, allocs_per_op });
+    return ns_per_op;
+}
+
+} // namespace bench
+
+// Counting replacements of the global allocation functions. The sized and
+// aligned forms of operator new funnel into these.
+void* operator new(std::size_t bytes) {
+    bench::allocation_count.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(bytes ? bytes : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t bytes, std::align_val_t align) {
+    bench::allocation_count.fetch_add(1, std::memory_order_relaxed);
+    auto a = static_cast<std::size_t>(align);
+    if (void* p = std::aligned_alloc(a, (std::max<std::size_t>(bytes, 1) + a - 1) & ~(a - 1))) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
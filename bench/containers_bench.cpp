@@ -0,0 +1,573 @@
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <cstdlib>
+#include <functional>
+#include <optional>
+#include <ranges>
+#include <print>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "bench.hpp"
+#include "my/aho_corasick.hpp"
+#include "my/intern_table.hpp"
+#include "my/optional.hpp"
+#include "my/parse.hpp"
+#include "my/perfect_hash_map.hpp"
+#include "my/split.hpp"
+#include "my/string.hpp"
+#include "my/string_searcher.hpp"
+#include "my/string_view.hpp"
+#include "my/vector.hpp"
+
+// Each case runs against my:: and std:: with the same body; the container
+// family is picked by the template parameter.
+template<template<class...> class Vec>
+void bench_vector(std::string_view prefix, std::size_t n) {
+    auto name = [&](std::string_view what) { return std::format("{} {}", prefix, what); };
+
+    bench::run(name("push_back"), n, [&] {
+        Vec<int> v{};
+        for (std::size_t i = 0; i < n; ++i) {
+            v.push_back(static_cast<int>(i));
+        }
+        bench::do_not_optimize(v.data());
+    });
+
+    bench::run(name("push_back after reserve"), n, [&] {
+        Vec<int> v{};
+        v.reserve(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            v.push_back(static_cast<int>(i));
+        }
+        bench::do_not_optimize(v.data());
+    });
+
+    std::size_t n_insert = n / 64;
+    bench::run(name("insert in the middle"), n_insert, [&] {
+        Vec<int> v(n_insert / 2, 0);
+        for (std::size_t i = 0; i < n_insert; ++i) {
+            v.insert(v.begin() + static_cast<std::ptrdiff_t>(v.size() / 2), static_cast<int>(i));
+        }
+        bench::do_not_optimize(v.data());
+    });
+
+    Vec<std::string> strings(n / 16, std::string(32, 'x'));
+    bench::run(name("copy of strings"), strings.size(), [&] {
+        Vec<std::string> copy{strings};
+        bench::do_not_optimize(copy.data());
+    });
+
+    bench::run(name("move of strings"), 1, [&] {
+        Vec<std::string> moved{std::move(strings)};
+        bench::do_not_optimize(moved.data());
+        strings = Vec<std::string>{std::move(moved)};
+    });
+}
+
+template<class String>
+void bench_string(std::string_view prefix, std::size_t n) {
+    auto name = [&](std::string_view what) { return std::format("{} {}", prefix, what); };
+
+    // 21-char keys: inline in my::string, past libstdc++'s 15-char buffer
+    std::vector<std::string> keys;
+    for (std::size_t i = 0; i < 1024; ++i) {
+        keys.push_back(std::format("user:{:08}:profile", i * 7919));
+    }
+    bench::run(name("short key copies"), n, [&] {
+        std::size_t total = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            const std::string& key = keys[i % keys.size()];
+            String copy(key.data(), key.size());
+            bench::do_not_optimize(copy.data());
+            total += copy.size();
+        }
+        bench::do_not_optimize(total);
+    });
+
+    bench::run(name("append char"), n, [&] {
+        String s;
+        for (std::size_t i = 0; i < n; ++i) {
+            s.push_back(static_cast<char>('a' + i % 26));
+        }
+        bench::do_not_optimize(s.data());
+    });
+
+    // ops are bytes appended
+    std::string_view piece = "0123456789abcdef";
+    bench::run(name("append 16-byte pieces"), n, [&] {
+        String s;
+        for (std::size_t i = 0; i < n; i += piece.size()) {
+            s.append(piece.data(), piece.size());
+        }
+        bench::do_not_optimize(s.data());
+    });
+}
+
+template<class StringView>
+void bench_string_view(std::string_view prefix, const std::string& text) {
+    auto name = [&](std::string_view what) { return std::format("{} {}", prefix, what); };
+    StringView haystack{text.data(), text.size()};
+
+    bench::run(name("find substring"), text.size(), [&] {
+        bench::do_not_optimize(haystack.find(StringView{"needle in a haystack"}));
+    });
+
+    // log lines: the first char of the needle shows up in every timestamp
+    std::string log;
+    while (log.size() < text.size()) {
+        log += "2024-05-17 12:34:56.789 INFO request served in 12 ms\n";
+    }
+    log += "2024-05-17 12:34:57.001 ERROR upstream timeout\n";
+    StringView log_view{log.data(), log.size()};
+    bench::run(name("find substring in log text"), log.size(), [&] {
+        bench::do_not_optimize(log_view.find(StringView{"2024-05-17 12:34:57"}));
+    });
+
+    // adversarial: every window of the haystack matches the needle up to the
+    // 'b', which costs a naive search O(n * m) for find and rfind alike
+    std::string run_of_a(text.size(), 'a');
+    std::string needle_aba = std::string(128, 'a') + "b" + std::string(128, 'a');
+    StringView run_view{run_of_a.data(), run_of_a.size()};
+    StringView aba_view{needle_aba.data(), needle_aba.size()};
+    bench::run(name("find a..aba..a in aaa...a"), run_of_a.size(), [&] {
+        bench::do_not_optimize(run_view.find(aba_view));
+    });
+
+    bench::run(name("rfind a..aba..a in aaa...a"), run_of_a.size(), [&] {
+        bench::do_not_optimize(run_view.rfind(aba_view));
+    });
+
+    bench::run(name("rfind substring"), text.size(), [&] {
+        bench::do_not_optimize(haystack.rfind(StringView{"haystack that is not there at all"}));
+    });
+
+    bench::run(name("find char"), text.size(), [&] {
+        bench::do_not_optimize(haystack.find('#'));
+    });
+
+    bench::run(name("find_first_of"), text.size(), [&] {
+        bench::do_not_optimize(haystack.find_first_of(StringView{"#@$%"}));
+    });
+
+    // delimiter-style sets: the scan stops at the first non-blank / last non-letter
+    StringView tokens{" \t\r\n,;:|=&?!#"};
+    bench::run(name("find_first_of delimiters"), text.size(), [&] {
+        bench::do_not_optimize(haystack.find_first_of(tokens));
+    });
+
+    bench::run(name("find_last_not_of letters"), text.size(), [&] {
+        bench::do_not_optimize(haystack.find_last_not_of(StringView{"an"}, text.size() - 22));
+    });
+}
+
+// One needle against many short lines, prepared once where the API allows.
+void bench_searcher(std::size_t n_lines) {
+    std::vector<std::string> lines;
+    for (std::size_t i = 0; i < n_lines; ++i) {
+        lines.push_back(std::format("2024-05-17 12:34:{:02}.{:03} INFO request {} served in {} ms",
+                                    i % 60, i % 1000, i, i % 97));
+    }
+    lines.back() = "2024-05-17 12:35:00.000 ERROR upstream timeout after 30000 ms";
+    constexpr std::string_view needle = "upstream timeout";
+
+    bench::run("my::string_view::find per line", n_lines, [&] {
+        std::size_t hits = 0;
+        for (const std::string& line : lines) {
+            hits += my::string_view{line.data(), line.size()}.find(
+                        my::string_view{needle.data(), needle.size()}) != my::string_view::npos;
+        }
+        bench::do_not_optimize(hits);
+    });
+
+    my::string_searcher searcher{my::string_view{needle.data(), needle.size()}};
+    bench::run("my::string_searcher per line", n_lines, [&] {
+        std::size_t hits = 0;
+        for (const std::string& line : lines) {
+            hits += searcher.find(my::string_view{line.data(), line.size()}) != my::string_view::npos;
+        }
+        bench::do_not_optimize(hits);
+    });
+
+    bench::run("std::string_view::find per line", n_lines, [&] {
+        std::size_t hits = 0;
+        for (const std::string& line : lines) {
+            hits += std::string_view{line}.find(needle) != std::string_view::npos;
+        }
+        bench::do_not_optimize(hits);
+    });
+
+    std::boyer_moore_horspool_searcher std_searcher{needle.begin(), needle.end()};
+    bench::run("std::boyer_moore_horspool_searcher per line", n_lines, [&] {
+        std::size_t hits = 0;
+        for (const std::string& line : lines) {
+            hits += std::search(line.begin(), line.end(), std_searcher) != line.end();
+        }
+        bench::do_not_optimize(hits);
+    });
+}
+
+// Hundreds of keywords against every line, in one pass or one find each.
+void bench_keywords(std::size_t n_lines) {
+    std::vector<std::string> keywords;
+    for (std::size_t i = 0; i < 200; ++i) {
+        keywords.push_back(std::format("kw{}_{}", i * 7919 % 1000, i));
+    }
+    keywords.push_back("timeout");
+    std::vector<std::string> lines;
+    for (std::size_t i = 0; i < n_lines; ++i) {
+        lines.push_back(std::format("2024-05-17 12:34:{:02} INFO request {} served {} in {} ms",
+                                    i % 60, i, (i % 50 == 0) ? "after timeout" : "ok", i % 97));
+    }
+    std::size_t ops = n_lines * keywords.size();
+
+    my::aho_corasick automaton{keywords};
+    bench::run("my::aho_corasick per keyword and line", ops, [&] {
+        std::size_t hits = 0;
+        for (const std::string& line : lines) {
+            automaton.for_each_match(my::string_view{line.data(), line.size()},
+                                     [&](my::pattern_match) { ++hits; });
+        }
+        bench::do_not_optimize(hits);
+    });
+
+    std::vector<my::string_searcher> searchers;
+    for (const std::string& keyword : keywords) {
+        searchers.emplace_back(my::string_view{keyword.data(), keyword.size()});
+    }
+    bench::run("my::string_searcher per keyword and line", ops, [&] {
+        std::size_t hits = 0;
+        for (const std::string& line : lines) {
+            for (const my::string_searcher& searcher : searchers) {
+                hits += searcher.find(my::string_view{line.data(), line.size()}) != my::string_view::npos;
+            }
+        }
+        bench::do_not_optimize(hits);
+    });
+
+    bench::run("std::string_view::find per keyword and line", ops, [&] {
+        std::size_t hits = 0;
+        for (const std::string& line : lines) {
+            for (const std::string& keyword : keywords) {
+                hits += std::string_view{line}.find(keyword) != std::string_view::npos;
+            }
+        }
+        bench::do_not_optimize(hits);
+    });
+}
+
+// Hash throughput by key length; ops are keys hashed.
+void bench_hash(std::size_t n) {
+    std::string bytes(std::size_t{1} << 16, '\0');
+    for (std::size_t i = 0; i < bytes.size(); ++i) {
+        bytes[i] = static_cast<char>(i * 2654435761u >> 13);
+    }
+    for (std::size_t len : {8, 16, 32, 64, 256, 1024, 16384}) {
+        // about 16 n bytes per run, so long keys do not take over
+        std::size_t keys = std::max<std::size_t>(n * 16 / std::max<std::size_t>(len, 64), 1);
+        auto offset = [&](std::size_t i) { return (i * 64) % (bytes.size() - len + 1); };
+
+        bench::run(std::format("std::hash<my::string_view> {:5} bytes", len), keys, [&] {
+            std::hash<my::string_view> hash;
+            std::size_t mixed = 0;
+            for (std::size_t i = 0; i < keys; ++i) {
+                mixed ^= hash(my::string_view{bytes.data() + offset(i), len});
+            }
+            bench::do_not_optimize(mixed);
+        });
+        bench::run(std::format("std::hash<std::string_view> {:5} bytes", len), keys, [&] {
+            std::hash<std::string_view> hash;
+            std::size_t mixed = 0;
+            for (std::size_t i = 0; i < keys; ++i) {
+                mixed ^= hash(std::string_view{bytes.data() + offset(i), len});
+            }
+            bench::do_not_optimize(mixed);
+        });
+    }
+}
+
+// Field-name lookups in a few thousand names, by atom and by string_view.
+void bench_atoms(std::size_t n) {
+    std::vector<std::string> names;
+    for (std::size_t i = 0; i < 4096; ++i) {
+        names.push_back(std::format("request.header.field_{:04}", i * 7919 % 4096));
+    }
+    my::intern_table table;
+    std::vector<my::atom> atoms;
+    for (const std::string& name : names) {
+        atoms.push_back(table.intern(my::string_view{name.data(), name.size()}));
+    }
+    my::atom wanted = atoms[atoms.size() / 2];
+    my::string_view wanted_view = wanted;
+
+    bench::run("my::atom ==", n, [&] {
+        std::size_t hits = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            hits += atoms[i % atoms.size()] == wanted;
+        }
+        bench::do_not_optimize(hits);
+    });
+
+    bench::run("my::string_view ==", n, [&] {
+        std::size_t hits = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            const std::string& name = names[i % names.size()];
+            hits += my::string_view{name.data(), name.size()} == wanted_view;
+        }
+        bench::do_not_optimize(hits);
+    });
+
+    bench::run("my::intern_table::intern of a known name", n, [&] {
+        std::size_t total = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            const std::string& name = names[i % names.size()];
+            total += table.intern(my::string_view{name.data(), name.size()}).size();
+        }
+        bench::do_not_optimize(total);
+    });
+}
+
+// Fields of comma-separated lines; ops are fields.
+void bench_split(std::size_t n_lines) {
+    std::vector<std::string> lines;
+    std::size_t fields = 0;
+    for (std::size_t i = 0; i < n_lines; ++i) {
+        lines.push_back(std::format("{},user{},{}.{},,GET,/api/v1/items/{},200,{}",
+                                    i, i % 1000, i * 31 % 997, i % 10, i * 7, i % 5000));
+        fields += 8;
+    }
+
+    bench::run("my::split", fields, [&] {
+        std::size_t total = 0;
+        for (const std::string& line : lines) {
+            for (my::string_view field : my::split(my::string_view{line.data(), line.size()}, ',')) {
+                total += field.size();
+            }
+        }
+        bench::do_not_optimize(total);
+    });
+
+    bench::run("my::string_view::find + substr", fields, [&] {
+        std::size_t total = 0;
+        for (const std::string& line : lines) {
+            my::string_view rest{line.data(), line.size()};
+            while (true) {
+                std::size_t comma = rest.find(',');
+                total += rest.substr(0, comma).size();
+                if (comma == my::string_view::npos) break;
+                rest = rest.substr(comma + 1);
+            }
+        }
+        bench::do_not_optimize(total);
+    });
+
+    bench::run("std::views::split", fields, [&] {
+        std::size_t total = 0;
+        for (const std::string& line : lines) {
+            for (auto field : std::string_view{line} | std::views::split(',')) {
+                total += std::ranges::size(field);
+            }
+        }
+        bench::do_not_optimize(total);
+    });
+}
+
+// 200 command names, "cmd000" to "cmd199", as constants
+constexpr std::size_t n_commands = 200;
+constexpr auto command_names = [] {
+    std::array<std::array<char, 6>, n_commands> names{};
+    for (std::size_t i = 0; i < n_commands; ++i) {
+        names[i] = {'c', 'm', 'd', static_cast<char>('0' + i / 100),
+                    static_cast<char>('0' + i / 10 % 10), static_cast<char>('0' + i % 10)};
+    }
+    return names;
+}();
+
+// Maps command names to their ids, the way a protocol dispatcher would.
+void bench_dispatch(std::size_t n) {
+    static constexpr auto commands = my::make_perfect_hash_map([] {
+        std::array<my::pair<my::string_view, std::size_t>, n_commands> entries{};
+        for (std::size_t i = 0; i < n_commands; ++i) {
+            entries[i] = {my::string_view{command_names[i].data(), 6}, i};
+        }
+        return entries;
+    }());
+
+    // requests spread over every command, and a few unknown ones
+    std::vector<std::string> requests;
+    for (std::size_t i = 0; i < 4096; ++i) {
+        requests.push_back(std::format("cmd{:03}", i * 7919 % (n_commands + 8)));
+    }
+
+    bench::run("my::perfect_hash_map::find", n, [&] {
+        std::size_t total = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            const std::string& request = requests[i % requests.size()];
+            auto it = commands.find(my::string_view{request.data(), request.size()});
+            total += (it != commands.end()) ? it->second : 0;
+        }
+        bench::do_not_optimize(total);
+    });
+
+    bench::run("my::string_view == chain", n, [&] {
+        std::size_t total = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            const std::string& request = requests[i % requests.size()];
+            my::string_view key{request.data(), request.size()};
+            for (std::size_t c = 0; c < n_commands; ++c) {
+                if (key == my::string_view{command_names[c].data(), 6}) {
+                    total += c;
+                    break;
+                }
+            }
+        }
+        bench::do_not_optimize(total);
+    });
+
+    std::unordered_map<std::string_view, std::size_t> std_map;
+    for (std::size_t c = 0; c < n_commands; ++c) {
+        std_map.emplace(std::string_view{command_names[c].data(), 6}, c);
+    }
+    bench::run("std::unordered_map<std::string_view>::find", n, [&] {
+        std::size_t total = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            auto it = std_map.find(requests[i % requests.size()]);
+            total += (it != std_map.end()) ? it->second : 0;
+        }
+        bench::do_not_optimize(total);
+    });
+}
+
+// Numeric fields as they come out of a split; ops are fields.
+void bench_parse(std::size_t n) {
+    std::vector<std::string> ints;
+    std::vector<std::string> doubles;
+    for (std::size_t i = 0; i < n; ++i) {
+        ints.push_back(std::format("{}", static_cast<long>(i * 2654435761u % 100000000) - 50000000));
+        doubles.push_back(std::format("{}", static_cast<double>(i * 2654435761u % 1000000) / 997.0 - 500.0));
+    }
+
+    bench::run("my::parse<long>", n, [&] {
+        long total = 0;
+        for (const std::string& field : ints) {
+            total += *my::parse<long>(my::string_view{field.data(), field.size()});
+        }
+        bench::do_not_optimize(total);
+    });
+
+    bench::run("std::from_chars<long>", n, [&] {
+        long total = 0;
+        for (const std::string& field : ints) {
+            long value = 0;
+            std::from_chars(field.data(), field.data() + field.size(), value);
+            total += value;
+        }
+        bench::do_not_optimize(total);
+    });
+
+    bench::run("my::parse<double>", n, [&] {
+        double total = 0;
+        for (const std::string& field : doubles) {
+            total += *my::parse<double>(my::string_view{field.data(), field.size()});
+        }
+        bench::do_not_optimize(total);
+    });
+
+    bench::run("std::from_chars<double>", n, [&] {
+        double total = 0;
+        for (const std::string& field : doubles) {
+            double value = 0;
+            std::from_chars(field.data(), field.data() + field.size(), value);
+            total += value;
+        }
+        bench::do_not_optimize(total);
+    });
+
+    // copying each field out of its line, to get a null char for strtod
+    bench::run("std::string + strtod", n, [&] {
+        double total = 0;
+        for (const std::string& field : doubles) {
+            std::string copy{std::string_view{field}};
+            total += std::strtod(copy.c_str(), nullptr);
+        }
+        bench::do_not_optimize(total);
+    });
+}
+
+template<template<class> class Optional>
+void bench_optional(std::string_view prefix, std::size_t n) {
+    auto name = [&](std::string_view what) { return std::format("{} {}", prefix, what); };
+
+    auto half = [](int x) -> Optional<int> {
+        if (x % 2 != 0) return {};
+        return x / 2;
+    };
+    bench::run(name("and_then/transform/or_else chain"), n, [&] {
+        long sum = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            Optional<int> start{static_cast<int>(i)};
+            auto out = start.and_then(half)
+                            .and_then(half)
+                            .transform([](int x) { return x + 1; })
+                            .or_else([] { return Optional<int>{0}; });
+            sum += *out;
+        }
+        bench::do_not_optimize(sum);
+    });
+}
+
+template<class T> using std_vector = std::vector<T>;
+template<class T> using my_vector = my::vector<T>;
+template<class T> using std_optional = std::optional<T>;
+template<class T> using my_optional = my::optional<T>;
+
+int main(int argc, char** argv) {
+    std::size_t n = (argc > 1) ? std::stoull(argv[1]) : std::size_t{1} << 20;
+
+    std::println("vector, {} elements", n);
+    bench_vector<my_vector>("my::vector", n);
+    bench_vector<std_vector>("std::vector", n);
+
+    std::println("string, {} chars", n);
+    bench_string<my::string>("my::string", n);
+    bench_string<std::string>("std::string", n);
+
+    // plain text with no match until the very end
+    std::string text(n, 'a');
+    for (std::size_t i = 0; i < n; i += 7) {
+        text[i] = 'n';
+    }
+    text += "needle in a haystack#";
+    std::println("string_view, {} bytes", text.size());
+    bench_string_view<my::string_view>("my::string_view", text);
+    bench_string_view<std::string_view>("std::string_view", text);
+
+    std::println("searcher, {} lines", n / 16);
+    bench_searcher(n / 16);
+
+    std::println("keywords, {} lines", n / 256);
+    bench_keywords(n / 256);
+
+    std::println("hash, by key length");
+    bench_hash(n);
+
+    std::println("atoms, {} comparisons", n);
+    bench_atoms(n);
+
+    std::println("split, {} lines", n / 16);
+    bench_split(n / 16);
+
+    std::println("dispatch, {} lookups", n);
+    bench_dispatch(n);
+
+    std::println("parse, {} fields", n);
+    bench_parse(n);
+
+    std::println("optional, {} chains", n);
+    bench_optional<my_optional>("my::optional", n);
+    bench_optional<std_optional>("std::optional", n);
+}
@@ -0,0 +1,65 @@
+#include <cstddef>
+#include <cstdint>
+#include <print>
+#include <string>
+#include "bench.hpp"
+#include "my/memory.hpp"
+#include "my/mmap_allocator.hpp"
+#include "my/vector.hpp"
+
+// xorshift64, so that the index stream costs next to nothing
+inline std::uint64_t next_random(std::uint64_t& state) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+template<class Alloc>
+void bench_allocator(std::string_view name, std::size_t n, std::size_t lookups) {
+    std::println("{}", name);
+    my::vector<std::uint64_t, Alloc> v{};
+
+    // includes the page faults of the first touch
+    bench::run("  fill", n, [&] {
+        my::vector<std::uint64_t, Alloc> w{};
+        w.resize_for_overwrite(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            w[i] = i;
+        }
+        bench::do_not_optimize(w.data());
+        v.swap(w);
+    }, 1);
+
+    // dependent loads: each index depends on the previous value
+    bench::run("  random dependent reads", lookups, [&] {
+        std::uint64_t state = 88172645463325252ull;
+        std::uint64_t sum = 0;
+        for (std::size_t i = 0; i < lookups; ++i) {
+            sum += v[(next_random(state) ^ sum) % n];
+        }
+        bench::do_not_optimize(sum);
+    });
+
+    bench::run("  random independent reads", lookups, [&] {
+        std::uint64_t state = 88172645463325252ull;
+        std::uint64_t sum = 0;
+        for (std::size_t i = 0; i < lookups; ++i) {
+            sum += v[next_random(state) % n];
+        }
+        bench::do_not_optimize(sum);
+    });
+}
+
+int main(int argc, char** argv) {
+    // 4 GiB of uint64_t by default
+    std::size_t gib = (argc > 1) ? std::stoull(argv[1]) : 4;
+    std::size_t n = (gib << 30) / sizeof(std::uint64_t);
+    std::size_t lookups = std::size_t{1} << 24;
+    std::println("random access over {} GiB ({} elements)", gib, n);
+
+    bench_allocator<my::allocator<std::uint64_t>>("my::allocator", n, lookups);
+    bench_allocator<my::mmap_allocator<std::uint64_t>>("my::mmap_allocator", n, lookups);
+    bench_allocator<my::mmap_allocator<std::uint64_t, std::size_t{2} << 20, true>>(
+        "my::mmap_allocator (populated)", n, lookups);
+}
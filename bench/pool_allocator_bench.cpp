@@ -0,0 +1,76 @@
+#include <array>
+#include <cstddef>
+#include <print>
+#include <string>
+#include <thread>
+#include <vector>
+#include "bench.hpp"
+#include "my/memory.hpp"
+#include "my/pool_allocator.hpp"
+
+// a typical node-sized object
+struct node {
+    std::array<std::size_t, 6> payload;
+};
+
+template<class Alloc>
+using node_ptr = decltype(my::allocate_unique<node>(Alloc{}));
+
+template<class F>
+void run_threads(std::size_t n_threads, F body) {
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < n_threads; ++t) {
+        threads.emplace_back(body, t);
+    }
+    for (auto& th : threads) {
+        th.join();
+    }
+}
+
+// Every thread keeps a window of live objects and replaces one per step,
+// so each step is one allocation and one free on the same thread.
+template<class Alloc>
+void bench_churn(std::string_view name, std::size_t n_threads, std::size_t rounds) {
+    constexpr std::size_t window = 64;
+    bench::run(name, n_threads * rounds, [&] {
+        run_threads(n_threads, [rounds](std::size_t) {
+            std::vector<node_ptr<Alloc>> live(window);
+            for (std::size_t r = 0; r < rounds; ++r) {
+                live[r % window] = my::allocate_unique<node>(Alloc{}, node{{r}});
+                bench::do_not_optimize(live[r % window].get());
+            }
+        });
+    });
+}
+
+// Thread t allocates a batch that thread t + 1 then frees, the way a
+// producer hands work items to a consumer.
+template<class Alloc>
+void bench_handoff(std::string_view name, std::size_t n_threads, std::size_t rounds) {
+    static constexpr std::size_t batch = 1024;
+    std::vector<std::vector<node_ptr<Alloc>>> batches(n_threads);
+    bench::run(name, n_threads * rounds, [&] {
+        for (std::size_t done = 0; done < rounds; done += batch) {
+            run_threads(n_threads, [&batches](std::size_t t) {
+                for (std::size_t i = 0; i < batch; ++i) {
+                    batches[t].push_back(my::allocate_unique<node>(Alloc{}, node{{i}}));
+                }
+            });
+            run_threads(n_threads, [&batches, n_threads](std::size_t t) {
+                batches[(t + 1) % n_threads].clear();
+            });
+        }
+    });
+}
+
+int main(int argc, char** argv) {
+    std::size_t n_threads = (argc > 1) ? std::stoull(argv[1]) : std::thread::hardware_concurrency();
+    std::size_t rounds = (argc > 2) ? std::stoull(argv[2]) : std::size_t{1} << 20;
+    std::println("allocate_unique churn, {} threads x {} objects of {} bytes (ns per object)",
+                 n_threads, rounds, sizeof(node));
+
+    bench_churn<my::allocator<node>>("churn, my::allocator (operator new)", n_threads, rounds);
+    bench_churn<my::pool_allocator<node>>("churn, my::pool_allocator", n_threads, rounds);
+    bench_handoff<my::allocator<node>>("handoff, my::allocator (operator new)", n_threads, rounds);
+    bench_handoff<my::pool_allocator<node>>("handoff, my::pool_allocator", n_threads, rounds);
+}
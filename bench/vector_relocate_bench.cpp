@@ -0,0 +1,69 @@
+#include <cstddef>
+#include <print>
+#include <string>
+#include "bench.hpp"
+#include "my/memory.hpp"
+#include "my/utility.hpp"
+#include "my/vector.hpp"
+
+// Same layout as my::pair<int, double>, but opted out of trivial relocation,
+// so vector falls back to the element-wise move + destroy loop.
+struct legacy_pair : my::pair<int, double> {
+    using my::pair<int, double>::pair;
+};
+
+template<>
+struct my::is_trivially_relocatable<legacy_pair> : std::false_type {};
+
+// Same as my::unique_ptr<int>, but opted out of trivial relocation.
+struct legacy_handle : my::unique_ptr<int> {
+    using my::unique_ptr<int>::unique_ptr;
+};
+
+template<>
+struct my::is_trivially_relocatable<legacy_handle> : std::false_type {};
+
+template<class T, class... Args>
+void bench_growth(std::string_view name, std::size_t n, const Args&... args) {
+    bench::run(name, n, [&] {
+        my::vector<T> v{};
+        for (std::size_t i = 0; i < n; ++i) {
+            v.emplace_back(args...);
+        }
+        bench::do_not_optimize(v.data());
+    });
+}
+
+// Each round trip relocates every element twice: into a larger buffer and
+// back into an exactly sized one.
+template<class T, class... Args>
+void bench_relocation(std::string_view name, std::size_t n, const Args&... args) {
+    my::vector<T> v{};
+    v.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        v.emplace_back(args...);
+    }
+    bench::run(name, 2 * n, [&] {
+        v.reserve(2 * n);
+        v.shrink_to_fit();
+        bench::do_not_optimize(v.data());
+    });
+}
+
+int main(int argc, char** argv) {
+    std::size_t n = (argc > 1) ? std::stoull(argv[1]) : std::size_t{1} << 23;
+    std::println("push_back growth to {} elements", n);
+
+    bench_growth<my::pair<int, double>>("my::pair<int, double> (relocatable)", n, 1, 0.5);
+    bench_growth<legacy_pair>("my::pair<int, double> (move + destroy)", n, 1, 0.5);
+
+    // null handles, so that only the vector growth is measured
+    bench_growth<my::unique_ptr<int>>("my::unique_ptr<int> (relocatable)", n, nullptr);
+    bench_growth<legacy_handle>("my::unique_ptr<int> (move + destroy)", n, nullptr);
+
+    std::println("reserve/shrink_to_fit round trips over {} elements", n);
+    bench_relocation<my::pair<int, double>>("my::pair<int, double> (relocatable)", n, 1, 0.5);
+    bench_relocation<legacy_pair>("my::pair<int, double> (move + destroy)", n, 1, 0.5);
+    bench_relocation<my::unique_ptr<int>>("my::unique_ptr<int> (relocatable)", n, nullptr);
+    bench_relocation<legacy_handle>("my::unique_ptr<int> (move + destroy)", n, nullptr);
+}
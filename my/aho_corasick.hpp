@@ -0,0 +1,255 @@
+#pragma once
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <limits>
+#include <ranges>
+#include <stdexcept>
+#include "string_view.hpp"
+#include "vector.hpp"
+
+namespace my {
+
+// One occurrence of a pattern: its index in the pattern list, and the offset
+// of its first char in the text (counted from the start of the stream when
+// scanning in chunks).
+struct pattern_match {
+    std::size_t pattern;
+    std::size_t offset;
+
+    friend constexpr bool operator==(const pattern_match&, const pattern_match&) = default;
+};
+
+// Multi-pattern matcher: an Aho-Corasick automaton compiled into a full DFA,
+// so the scan is one table load per byte with no failure-link walks.
+//
+// Bytes that occur in no pattern share one class, and the table has a row
+// of classes per state, which keeps it small for typical keyword sets. Rows
+// are addressed by premultiplied offsets, and states with matches are
+// numbered last, so the hot loop is a load, an add and a compare. Empty
+// patterns never match.
+class aho_corasick {
+    using state_type = std::uint32_t;
+
+    std::array<std::uint8_t, 256> m_classes{};
+    std::size_t m_alphabet = 1;
+    // m_next[state + class] is the next state, all premultiplied by m_alphabet
+    vector<state_type> m_next;
+    // states from here on report matches
+    state_type m_first_match = 0;
+    // patterns ending in match state k, in m_outputs[m_output_begin[k], m_output_begin[k + 1])
+    vector<std::uint32_t> m_output_begin;
+    vector<std::uint32_t> m_outputs;
+    vector<std::size_t> m_lengths;
+
+public:
+    class scanner;
+
+    // constructors
+    template<std::ranges::input_range R>
+        requires std::constructible_from<string_view, std::ranges::range_reference_t<R>>
+    explicit aho_corasick(R&& patterns) {
+        vector<string_view> list;
+        for (auto&& pattern : patterns) {
+            list.push_back(string_view(pattern));
+        }
+        build(list);
+    }
+
+    aho_corasick(std::initializer_list<string_view> patterns) :
+        aho_corasick(std::ranges::subrange(patterns.begin(), patterns.end())) {}
+
+    std::size_t pattern_count() const noexcept {
+        return m_lengths.size();
+    }
+
+    std::size_t state_count() const noexcept {
+        return m_next.size() / m_alphabet;
+    }
+
+    // Calls on_match(pattern_match) for every occurrence of every pattern in
+    // text, ordered by where the occurrence ends, longer patterns first.
+    template<class F>
+    void for_each_match(string_view text, F&& on_match) const {
+        scan(0, text, 0, on_match);
+    }
+
+    vector<pattern_match> find_all(string_view text) const {
+        vector<pattern_match> matches;
+        for_each_match(text, [&](pattern_match match) { matches.push_back(match); });
+        return matches;
+    }
+
+    bool contains_any(string_view text) const noexcept {
+        state_type state = 0;
+        for (char ch : text) {
+            state = m_next[state + m_classes[static_cast<unsigned char>(ch)]];
+            if (state >= m_first_match) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    // Runs the automaton over text from `state`, with text[0] at stream
+    // offset `position`, and returns the state after the last byte.
+    template<class F>
+    state_type scan(state_type state, string_view text, std::size_t position, F& on_match) const {
+        const state_type* next = m_next.data();
+        const std::size_t n = text.size();
+        for (std::size_t i = 0; i < n; ++i) {
+            state = next[state + m_classes[static_cast<unsigned char>(text[i])]];
+            if (state >= m_first_match) [[unlikely]] {
+                std::size_t k = (state - m_first_match) / m_alphabet;
+                std::size_t end = position + i + 1;
+                for (std::uint32_t j = m_output_begin[k]; j < m_output_begin[k + 1]; ++j) {
+                    std::uint32_t pattern = m_outputs[j];
+                    on_match(pattern_match{pattern, end - m_lengths[pattern]});
+                }
+            }
+        }
+        return state;
+    }
+
+    void build(const vector<string_view>& patterns) {
+        // byte classes: every byte that occurs in a pattern gets its own
+        // class, and class 0 is shared by all the others
+        std::array<bool, 256> used{};
+        for (string_view pattern : patterns) {
+            for (char ch : pattern) {
+                used[static_cast<unsigned char>(ch)] = true;
+            }
+        }
+        std::size_t n_used = 0;
+        for (bool u : used) {
+            n_used += u;
+        }
+        std::size_t next_class = (n_used == 256) ? 0 : 1;
+        for (std::size_t byte = 0; byte < 256; ++byte) {
+            if (used[byte]) {
+                m_classes[byte] = static_cast<std::uint8_t>(next_class++);
+            }
+        }
+        m_alphabet = next_class;
+        const std::size_t alphabet = m_alphabet;
+
+        // trie, with missing edges as `none`
+        constexpr state_type none = std::numeric_limits<state_type>::max();
+        vector<state_type> next(alphabet, none);
+        vector<vector<std::uint32_t>> outputs(1);
+        for (std::size_t id = 0; id < patterns.size(); ++id) {
+            m_lengths.push_back(patterns[id].size());
+            if (patterns[id].empty()) {
+                continue;
+            }
+            std::size_t state = 0;
+            for (char ch : patterns[id]) {
+                state_type& edge = next[state * alphabet + m_classes[static_cast<unsigned char>(ch)]];
+                if (edge == none) {
+                    if (outputs.size() >= std::numeric_limits<state_type>::max() / alphabet) {
+                        throw std::length_error("aho_corasick: too many states");
+                    }
+                    edge = static_cast<state_type>(outputs.size());
+                    outputs.emplace_back();
+                    next.resize(next.size() + alphabet, none);
+                }
+                state = next[state * alphabet + m_classes[static_cast<unsigned char>(ch)]];
+            }
+            outputs[state].push_back(static_cast<std::uint32_t>(id));
+        }
+        const std::size_t n_states = outputs.size();
+
+        // breadth first, so the failure state of every state is done before
+        // it: fill the missing edges from the failure state and inherit its
+        // matches
+        vector<state_type> fail(n_states, 0);
+        vector<state_type> order{0};
+        for (std::size_t head = 0; head < order.size(); ++head) {
+            std::size_t state = order[head];
+            for (std::size_t c = 0; c < alphabet; ++c) {
+                state_type& edge = next[state * alphabet + c];
+                if (edge == none) {
+                    edge = (state == 0) ? 0 : next[fail[state] * alphabet + c];
+                    continue;
+                }
+                fail[edge] = (state == 0) ? 0 : next[fail[state] * alphabet + c];
+                for (std::uint32_t id : outputs[fail[edge]]) {
+                    outputs[edge].push_back(id);
+                }
+                order.push_back(edge);
+            }
+        }
+
+        // renumber: states without matches first, the root staying 0
+        vector<state_type> rank(n_states, 0);
+        state_type n_ranked = 0;
+        for (bool matching : {false, true}) {
+            if (matching) {
+                m_first_match = static_cast<state_type>(n_ranked * alphabet);
+            }
+            for (state_type state : order) {
+                if (outputs[state].empty() != matching) {
+                    rank[state] = n_ranked++;
+                }
+            }
+        }
+
+        m_next.assign(n_states * alphabet, 0);
+        m_output_begin.assign(n_states - m_first_match / alphabet + 1, 0);
+        for (std::size_t state = 0; state < n_states; ++state) {
+            std::size_t row = rank[state] * alphabet;
+            for (std::size_t c = 0; c < alphabet; ++c) {
+                m_next[row + c] = static_cast<state_type>(rank[next[state * alphabet + c]] * alphabet);
+            }
+            if (!outputs[state].empty()) {
+                m_output_begin[rank[state] - m_first_match / alphabet + 1] =
+                    static_cast<std::uint32_t>(outputs[state].size());
+            }
+        }
+        for (std::size_t k = 1; k < m_output_begin.size(); ++k) {
+            m_output_begin[k] += m_output_begin[k - 1];
+        }
+        m_outputs.resize(m_output_begin.back());
+        for (std::size_t state = 0; state < n_states; ++state) {
+            if (!outputs[state].empty()) {
+                std::uint32_t at = m_output_begin[rank[state] - m_first_match / alphabet];
+                for (std::uint32_t id : outputs[state]) {
+                    m_outputs[at++] = id;
+                }
+            }
+        }
+    }
+}; // class aho_corasick
+
+// Feeds a stream to the automaton chunk by chunk; matches that span chunk
+// boundaries are reported with their offset in the whole stream. The
+// automaton must outlive the scanner.
+class aho_corasick::scanner {
+    const aho_corasick* m_automaton;
+    state_type m_state = 0;
+    std::size_t m_position = 0;
+
+public:
+    explicit scanner(const aho_corasick& automaton) noexcept : m_automaton{&automaton} {}
+
+    template<class F>
+    void feed(string_view chunk, F&& on_match) {
+        m_state = m_automaton->scan(m_state, chunk, m_position, on_match);
+        m_position += chunk.size();
+    }
+
+    // bytes fed so far
+    std::size_t position() const noexcept {
+        return m_position;
+    }
+
+    void reset() noexcept {
+        m_state = 0;
+        m_position = 0;
+    }
+}; // class aho_corasick::scanner
+
+} // namespace my
@@ -0,0 +1,89 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include "memory.hpp"
+
+// Growth policies decide the capacity of a container that ran out of room.
+//
+//     static constexpr std::size_t grow(std::size_t cap, std::size_t required,
+//                                       std::size_t elem_size) noexcept;
+//
+// returns the new capacity (in elements) when `required` elements must fit.
+// The container clamps the result to [required, max_size()].
+//
+// A policy may also provide
+//
+//     static constexpr std::size_t shrink(std::size_t size, std::size_t cap) noexcept;
+//
+// which the container consults after removing elements. Returning a value
+// below cap releases memory down to that capacity.
+
+namespace my {
+
+// Multiplies the capacity by Num / Den.
+template<std::size_t Num, std::size_t Den = 1>
+    requires (Num > Den) && (Den > 0)
+struct growth_factor {
+    static constexpr std::size_t grow(std::size_t cap, std::size_t required,
+                                      std::size_t) noexcept
+    {
+        constexpr std::size_t limit = std::numeric_limits<std::size_t>::max() / Num;
+        std::size_t grown = (cap > limit) ? std::numeric_limits<std::size_t>::max()
+                                          : cap * Num / Den;
+        return std::max(grown, required);
+    }
+};
+
+using doubling_growth = growth_factor<2>;
+using one_and_half_growth = growth_factor<3, 2>;
+
+// Rounds the capacity picked by Base up to the malloc size class of the
+// block, so that the tail of the block is not wasted.
+template<class Base = doubling_growth>
+struct size_class_growth : Base {
+    static constexpr std::size_t grow(std::size_t cap, std::size_t required,
+                                      std::size_t elem_size) noexcept
+    {
+        std::size_t count = Base::grow(cap, required, elem_size);
+        if (count > std::numeric_limits<std::size_t>::max() / elem_size) return count;
+        return std::max(count, malloc_size_class(count * elem_size) / elem_size);
+    }
+};
+
+// Once a buffer reaches Threshold bytes, rounds its size up to a multiple
+// of PageSize (2 MiB huge pages by default), so that it is backed by whole
+// huge pages.
+template<class Base = doubling_growth,
+         std::size_t Threshold = std::size_t{2} << 20,
+         std::size_t PageSize = std::size_t{2} << 20>
+struct huge_page_growth : Base {
+    static_assert((PageSize & (PageSize - 1)) == 0, "PageSize must be a power of two");
+
+    static constexpr std::size_t grow(std::size_t cap, std::size_t required,
+                                      std::size_t elem_size) noexcept
+    {
+        std::size_t count = Base::grow(cap, required, elem_size);
+        if (count > (std::numeric_limits<std::size_t>::max() - PageSize) / elem_size) return count;
+        std::size_t bytes = count * elem_size;
+        if (bytes < Threshold) return count;
+        return ((bytes + PageSize - 1) & ~(PageSize - 1)) / elem_size;
+    }
+};
+
+// Adds hysteresis-based shrinking to Base: once the size falls to
+// 1/Divisor of the capacity, the capacity is halved. Halving leaves room
+// for the size to double again before the next growth, so a queue that
+// hovers around one size does not thrash.
+template<class Base = doubling_growth, std::size_t Divisor = 4, std::size_t MinCapacity = 16>
+    requires (Divisor > 2)
+struct shrink_on_pop : Base {
+    using Base::grow;
+
+    static constexpr std::size_t shrink(std::size_t size, std::size_t cap) noexcept {
+        if (cap <= MinCapacity || size > cap / Divisor) return cap;
+        return std::max(cap / 2, MinCapacity);
+    }
+};
+
+} // namespace my
@@ -0,0 +1,255 @@
+#pragma once
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "hash_combine.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+// Byte hashing shared by the std::hash specializations of my:: types. Keys
+// up to long_key_threshold bytes go through a wyhash-style mixer; longer
+// ones are folded into eight lanes by a striped accumulator, the way xxh3
+// does, and that bulk loop picks the widest kernel the CPU supports on first
+// use. Every kernel computes the same value, and so does constant
+// evaluation. The seed changes the output, but this is not a keyed hash:
+// it gives no protection against inputs chosen to collide.
+
+namespace my {
+
+namespace {
+
+inline constexpr std::size_t long_key_threshold = 256;
+
+// The striped accumulator reads 64-byte stripes into eight lanes. Stripe s
+// of a block is keyed by stripe_secret[s, s + 8), and each full block ends
+// with a scramble keyed by the last eight words.
+inline constexpr std::size_t stripe_size = 64;
+inline constexpr std::size_t stripes_per_block = 16;
+inline constexpr std::size_t block_size = stripe_size * stripes_per_block;
+
+inline constexpr auto stripe_secret = [] {
+    std::array<std::uint64_t, stripes_per_block + 8> words{};
+    std::uint64_t state = 0x9e3779b97f4a7c15ull;
+    for (std::uint64_t& word : words) {
+        // splitmix64
+        std::uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        word = z ^ (z >> 31);
+    }
+    return words;
+}();
+
+inline constexpr std::uint64_t scramble_prime = 0x9e3779b1u;
+
+constexpr std::uint64_t read64(const char* p) noexcept {
+    if consteval {
+        std::uint64_t v = 0;
+        for (int i = 7; i >= 0; --i) {
+            v = (v << 8) | static_cast<unsigned char>(p[i]);
+        }
+        return v;
+    } else {
+        std::uint64_t v;
+        std::memcpy(&v, p, sizeof(v));
+        if constexpr (std::endian::native == std::endian::big) {
+            v = std::byteswap(v);
+        }
+        return v;
+    }
+}
+
+constexpr std::uint64_t read32(const char* p) noexcept {
+    if consteval {
+        std::uint64_t v = 0;
+        for (int i = 3; i >= 0; --i) {
+            v = (v << 8) | static_cast<unsigned char>(p[i]);
+        }
+        return v;
+    } else {
+        std::uint32_t v;
+        std::memcpy(&v, p, sizeof(v));
+        if constexpr (std::endian::native == std::endian::big) {
+            v = std::byteswap(v);
+        }
+        return v;
+    }
+}
+
+// Adds `stripes` consecutive stripes of p into acc. Lane l takes the
+// product of the two halves of (data ^ key), and its neighbour l ^ 1 takes
+// the data itself, so no input bit is lost to a zero multiplier.
+constexpr void accumulate_scalar(std::uint64_t* acc, const char* p, std::size_t stripes,
+                                 const std::uint64_t* key) noexcept {
+    for (std::size_t s = 0; s < stripes; ++s) {
+        for (std::size_t lane = 0; lane < 8; ++lane) {
+            std::uint64_t data = read64(p + s * stripe_size + lane * 8);
+            std::uint64_t keyed = data ^ key[s + lane];
+            acc[lane ^ 1] += data;
+            acc[lane] += (keyed & 0xffffffffu) * (keyed >> 32);
+        }
+    }
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("sse2")))
+inline void accumulate_sse2(std::uint64_t* acc, const char* p, std::size_t stripes,
+                            const std::uint64_t* key) noexcept {
+    __m128i lanes[4];
+    for (int j = 0; j < 4; ++j) {
+        lanes[j] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(acc) + j);
+    }
+    for (std::size_t s = 0; s < stripes; ++s) {
+        for (int j = 0; j < 4; ++j) {
+            __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + s * stripe_size) + j);
+            __m128i keyed = _mm_xor_si128(
+                data, _mm_loadu_si128(reinterpret_cast<const __m128i*>(key + s) + j));
+            __m128i product = _mm_mul_epu32(keyed, _mm_srli_epi64(keyed, 32));
+            __m128i swapped = _mm_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2));
+            lanes[j] = _mm_add_epi64(lanes[j], _mm_add_epi64(product, swapped));
+        }
+    }
+    for (int j = 0; j < 4; ++j) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(acc) + j, lanes[j]);
+    }
+}
+
+__attribute__((target("avx2")))
+inline void accumulate_avx2(std::uint64_t* acc, const char* p, std::size_t stripes,
+                            const std::uint64_t* key) noexcept {
+    __m256i lanes[2];
+    for (int j = 0; j < 2; ++j) {
+        lanes[j] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc) + j);
+    }
+    for (std::size_t s = 0; s < stripes; ++s) {
+        for (int j = 0; j < 2; ++j) {
+            __m256i data = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + s * stripe_size) + j);
+            __m256i keyed = _mm256_xor_si256(
+                data, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(key + s) + j));
+            __m256i product = _mm256_mul_epu32(keyed, _mm256_srli_epi64(keyed, 32));
+            // swaps the 64-bit halves of each 128-bit lane
+            __m256i swapped = _mm256_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2));
+            lanes[j] = _mm256_add_epi64(lanes[j], _mm256_add_epi64(product, swapped));
+        }
+    }
+    for (int j = 0; j < 2; ++j) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(acc) + j, lanes[j]);
+    }
+}
+#endif
+
+using accumulate_kernel = void (*)(std::uint64_t*, const char*, std::size_t,
+                                   const std::uint64_t*) noexcept;
+
+inline accumulate_kernel select_accumulate_kernel() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+    if (__builtin_cpu_supports("avx2")) {
+        return accumulate_avx2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return accumulate_sse2;
+    }
+#endif
+    return accumulate_scalar;
+}
+
+// The widest accumulate kernel of this CPU, picked on first use.
+inline accumulate_kernel best_accumulate_kernel() noexcept {
+    static const accumulate_kernel kernel = select_accumulate_kernel();
+    return kernel;
+}
+
+// len > long_key_threshold
+constexpr std::uint64_t hash_long(accumulate_kernel kernel, const char* p, std::size_t len,
+                                  std::uint64_t seed) noexcept {
+    std::uint64_t acc[8] = {
+        0x00000000c2b2ae3dull, 0x9e3779b185ebca87ull, 0xc2b2ae3d27d4eb4full, 0x165667b19e3779f9ull,
+        0x85ebca77c2b2ae63ull, 0x0000000085ebca77ull, 0x27d4eb2f165667c5ull, 0x000000009e3779b1ull,
+    };
+    // the last stripe is always taken from the end, so stop one byte short
+    std::size_t blocks = (len - 1) / block_size;
+    for (std::size_t b = 0; b < blocks; ++b) {
+        kernel(acc, p + b * block_size, stripes_per_block, stripe_secret.data());
+        for (std::size_t lane = 0; lane < 8; ++lane) {
+            std::uint64_t a = acc[lane];
+            a ^= a >> 47;
+            a ^= stripe_secret[stripes_per_block + lane];
+            acc[lane] = a * scramble_prime;
+        }
+    }
+    std::size_t tail = len - 1 - blocks * block_size;
+    kernel(acc, p + blocks * block_size, tail / stripe_size, stripe_secret.data());
+    kernel(acc, p + len - stripe_size, 1, stripe_secret.data() + 7);
+
+    std::uint64_t h = seed ^ (len * 0x9e3779b185ebca87ull);
+    for (std::size_t i = 0; i < 8; i += 2) {
+        h += wymix(acc[i] ^ stripe_secret[i + 9], acc[i + 1] ^ stripe_secret[i + 10]);
+    }
+    return wymix(h ^ wy_secret[0], len ^ wy_secret[1]);
+}
+
+constexpr std::uint64_t hash_bytes_with(accumulate_kernel kernel, const char* p, std::size_t len,
+                                        std::uint64_t seed) noexcept {
+    if (len > long_key_threshold) {
+        return hash_long(kernel, p, len, seed);
+    }
+    seed ^= wymix(seed ^ wy_secret[0], wy_secret[1]);
+    std::uint64_t a = 0;
+    std::uint64_t b = 0;
+    if (len <= 16) {
+        if (len >= 4) {
+            // two overlapping pairs of 4-byte reads cover 4 to 16 bytes
+            std::size_t mid = (len >> 3) << 2;
+            a = (read32(p) << 32) | read32(p + mid);
+            b = (read32(p + len - 4) << 32) | read32(p + len - 4 - mid);
+        } else if (len > 0) {
+            a = (std::uint64_t{static_cast<unsigned char>(p[0])} << 16) |
+                (std::uint64_t{static_cast<unsigned char>(p[len >> 1])} << 8) |
+                static_cast<unsigned char>(p[len - 1]);
+        }
+    } else {
+        std::size_t i = len;
+        if (i >= 48) {
+            std::uint64_t seed1 = seed;
+            std::uint64_t seed2 = seed;
+            do {
+                seed = wymix(read64(p) ^ wy_secret[1], read64(p + 8) ^ seed);
+                seed1 = wymix(read64(p + 16) ^ wy_secret[2], read64(p + 24) ^ seed1);
+                seed2 = wymix(read64(p + 32) ^ wy_secret[3], read64(p + 40) ^ seed2);
+                p += 48;
+                i -= 48;
+            } while (i >= 48);
+            seed ^= seed1 ^ seed2;
+        }
+        while (i > 16) {
+            seed = wymix(read64(p) ^ wy_secret[1], read64(p + 8) ^ seed);
+            p += 16;
+            i -= 16;
+        }
+        // the last 16 bytes, reaching back before p when fewer remain
+        a = read64(p + i - 16);
+        b = read64(p + i - 8);
+    }
+    unsigned __int128 r = static_cast<unsigned __int128>(a ^ wy_secret[1]) * (b ^ seed);
+    return wymix(static_cast<std::uint64_t>(r) ^ wy_secret[0] ^ len,
+                 static_cast<std::uint64_t>(r >> 64) ^ wy_secret[1]);
+}
+
+} // anonymous namespace
+
+// Hash of the bytes p[0, len).
+constexpr std::uint64_t hash_bytes(const char* p, std::size_t len,
+                                   std::uint64_t seed = 0) noexcept {
+    if consteval {
+        return hash_bytes_with(accumulate_scalar, p, len, seed);
+    } else {
+        return hash_bytes_with(len > long_key_threshold ? best_accumulate_kernel() : nullptr,
+                               p, len, seed);
+    }
+}
+
+} // namespace my
@@ -0,0 +1,29 @@
+#pragma once
+#include <cstdint>
+
+// The 64-bit mixer behind my::hash_bytes, split out so that headers which
+// only combine hashes (my::pair's std::hash, for one) need not pull in the
+// SIMD kernels of hash.hpp.
+
+namespace my {
+
+namespace {
+
+inline constexpr std::uint64_t wy_secret[4] = {
+    0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull, 0x4b33a62ed433d4a3ull, 0x4d5a2da51de1aa47ull,
+};
+
+// the two halves of the 128-bit product, folded together
+constexpr std::uint64_t wymix(std::uint64_t a, std::uint64_t b) noexcept {
+    unsigned __int128 r = static_cast<unsigned __int128>(a) * b;
+    return static_cast<std::uint64_t>(r) ^ static_cast<std::uint64_t>(r >> 64);
+}
+
+} // anonymous namespace
+
+// Combines two hashes, in order, into one well-mixed hash.
+constexpr std::uint64_t hash_combine(std::uint64_t seed, std::uint64_t h) noexcept {
+    return wymix(seed ^ wy_secret[0], h ^ wy_secret[2]);
+}
+
+} // namespace my
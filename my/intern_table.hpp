@@ -0,0 +1,237 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include "hash.hpp"
+#include "memory_resource.hpp"
+#include "string_view.hpp"
+
+namespace my {
+
+// Header of an interned string; the chars and a null char follow it in the
+// table's arena.
+struct atom_entry {
+    std::size_t hash;
+    std::size_t size;
+    const char* data;
+};
+
+// Handle to a string stored once in an intern_table. Two atoms from the
+// same table are equal exactly when their strings are, so comparing and
+// hashing look at the handle only. An atom stays valid for the lifetime of
+// its table. A default-constructed atom is the empty string, which every
+// table interns to the same handle.
+class atom {
+    static constexpr atom_entry empty_entry{hash_bytes("", 0), 0, ""};
+
+    const atom_entry* m_entry = &empty_entry;
+
+    friend class intern_table;
+    constexpr explicit atom(const atom_entry* entry) noexcept : m_entry{entry} {}
+
+public:
+    constexpr atom() noexcept = default;
+
+    constexpr const char* data() const noexcept {
+        return m_entry->data;
+    }
+
+    // null-terminated
+    constexpr const char* c_str() const noexcept {
+        return m_entry->data;
+    }
+
+    constexpr std::size_t size() const noexcept {
+        return m_entry->size;
+    }
+
+    constexpr bool empty() const noexcept {
+        return m_entry->size == 0;
+    }
+
+    constexpr string_view view() const noexcept {
+        return string_view(m_entry->data, m_entry->size);
+    }
+
+    constexpr operator string_view() const noexcept {
+        return view();
+    }
+
+    // std::hash of the string, computed once when it was interned
+    constexpr std::size_t hash() const noexcept {
+        return m_entry->hash;
+    }
+
+    friend constexpr bool operator==(atom lhs, atom rhs) noexcept {
+        return lhs.m_entry == rhs.m_entry;
+    }
+}; // class atom
+
+// Thread-safe table of distinct strings. Each string is copied once into an
+// arena and handed out as an atom. Lookups of strings already present are
+// lock-free: they probe an open-addressed table whose slots are only ever
+// filled, never moved or cleared. Inserts take a mutex. When the table
+// grows, the new one is published atomically and the old one is kept until
+// the intern_table dies, so readers still probing it stay safe.
+class intern_table {
+    using slot = std::atomic<const atom_entry*>;
+
+    struct slot_table {
+        std::size_t mask;
+        std::unique_ptr<slot[]> slots;
+        // retired smaller table, freed with this one
+        std::unique_ptr<slot_table> prev;
+
+        slot_table(std::size_t capacity, std::unique_ptr<slot_table> older) :
+            mask{capacity - 1}, slots{new slot[capacity]}, prev{std::move(older)}
+        {
+            for (std::size_t i = 0; i < capacity; ++i) {
+                slots[i].store(nullptr, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    std::atomic<slot_table*> m_table;
+    std::unique_ptr<slot_table> m_owned;
+    std::atomic<std::size_t> m_size{0};
+    // guards inserts, m_arena and m_owned
+    std::mutex m_mutex;
+    monotonic_arena m_arena;
+
+public:
+    // constructors
+    explicit intern_table(std::size_t expected = 64) :
+        m_owned{std::make_unique<slot_table>(capacity_for(expected), nullptr)}
+    {
+        m_table.store(m_owned.get(), std::memory_order_relaxed);
+    }
+
+    intern_table(const intern_table&) = delete;
+    intern_table& operator=(const intern_table&) = delete;
+
+    // Returns the atom for str, storing a copy of it on first sight.
+    atom intern(string_view str) {
+        if (str.empty()) {
+            return atom{};
+        }
+        std::size_t h = hash_of(str);
+        if (const atom_entry* e = lookup(m_table.load(std::memory_order_acquire), str, h)) {
+            return atom{e};
+        }
+
+        std::lock_guard lock{m_mutex};
+        slot_table* table = m_table.load(std::memory_order_relaxed);
+        // another thread may have inserted it since the lock-free probe
+        if (const atom_entry* e = lookup(table, str, h)) {
+            return atom{e};
+        }
+        std::size_t count = m_size.load(std::memory_order_relaxed) + 1;
+        if (count * 2 > table->mask + 1) {
+            table = grow();
+        }
+        const atom_entry* e = store(str, h);
+        slot& s = free_slot(table, h);
+        s.store(e, std::memory_order_release);
+        m_size.store(count, std::memory_order_relaxed);
+        return atom{e};
+    }
+
+    // Returns whether str is interned, and its atom in *out if so. Never
+    // blocks.
+    bool find(string_view str, atom* out = nullptr) const noexcept {
+        const atom_entry* e = str.empty()
+            ? atom{}.m_entry
+            : lookup(m_table.load(std::memory_order_acquire), str, hash_of(str));
+        if (e != nullptr && out != nullptr) {
+            *out = atom{e};
+        }
+        return e != nullptr;
+    }
+
+    bool contains(string_view str) const noexcept {
+        return find(str);
+    }
+
+    // distinct non-empty strings interned so far
+    std::size_t size() const noexcept {
+        return m_size.load(std::memory_order_relaxed);
+    }
+
+    // bytes held by the arena, slot tables excluded
+    std::size_t footprint() {
+        std::lock_guard lock{m_mutex};
+        return m_arena.footprint();
+    }
+
+private:
+    static std::size_t hash_of(string_view str) noexcept {
+        return std::hash<string_view>{}(str);
+    }
+
+    // power of two holding `expected` strings at most half full
+    static std::size_t capacity_for(std::size_t expected) noexcept {
+        std::size_t capacity = 16;
+        while (capacity / 2 < expected) {
+            capacity *= 2;
+        }
+        return capacity;
+    }
+
+    static const atom_entry* lookup(const slot_table* table, string_view str,
+                                    std::size_t h) noexcept {
+        for (std::size_t i = h & table->mask;; i = (i + 1) & table->mask) {
+            const atom_entry* e = table->slots[i].load(std::memory_order_acquire);
+            if (e == nullptr) {
+                return nullptr;
+            }
+            if (e->hash == h && string_view(e->data, e->size) == str) {
+                return e;
+            }
+        }
+    }
+
+    static slot& free_slot(slot_table* table, std::size_t h) noexcept {
+        std::size_t i = h & table->mask;
+        while (table->slots[i].load(std::memory_order_relaxed) != nullptr) {
+            i = (i + 1) & table->mask;
+        }
+        return table->slots[i];
+    }
+
+    // copies str and its null char into the arena, behind its header
+    const atom_entry* store(string_view str, std::size_t h) {
+        void* raw = m_arena.allocate(sizeof(atom_entry) + str.size() + 1, alignof(atom_entry));
+        char* chars = static_cast<char*>(raw) + sizeof(atom_entry);
+        std::char_traits<char>::copy(chars, str.data(), str.size());
+        chars[str.size()] = '\0';
+        return ::new (raw) atom_entry{h, str.size(), chars};
+    }
+
+    // Rehashes into a table twice the size and publishes it; the old one
+    // stays alive for readers still probing it.
+    slot_table* grow() {
+        slot_table* old = m_owned.get();
+        auto bigger = std::make_unique<slot_table>(2 * (old->mask + 1), std::move(m_owned));
+        for (std::size_t i = 0; i <= old->mask; ++i) {
+            if (const atom_entry* e = old->slots[i].load(std::memory_order_relaxed)) {
+                free_slot(bigger.get(), e->hash).store(e, std::memory_order_relaxed);
+            }
+        }
+        m_owned = std::move(bigger);
+        m_table.store(m_owned.get(), std::memory_order_release);
+        return m_owned.get();
+    }
+}; // class intern_table
+
+} // namespace my
+
+template<>
+struct std::hash<my::atom> {
+    std::size_t operator()(my::atom a) const noexcept {
+        return a.hash();
+    }
+};
@@ -1,53 +1,256 @@
 #pragma once
+#include <algorithm>
+#include <bit>
 #include <cstddef>
+#include <cstring>
 #include <type_traits>
 #include <concepts>
+#include <limits>
 #include <memory>
+#include <new>
 #include <utility>
 #include "utility.hpp"
 
 namespace my {
 
-template<class T>
+template<class Pointer, class SizeType = std::size_t>
+struct allocation_result {
+    Pointer ptr;
+    SizeType count;
+};
+
+// Memory held by a container's element buffer: bytes occupied by elements,
+// and bytes reserved but not in use.
+struct memory_usage_info {
+    std::size_t live_bytes;
+    std::size_t slack_bytes;
+};
+
+// Usable size of the block that malloc hands out for a request of `bytes`,
+// from the size-class layout of the platform allocator. Asking for this many
+// bytes instead of `bytes` costs no extra memory.
+constexpr std::size_t malloc_size_class(std::size_t bytes) noexcept {
+#if defined(__GLIBC__)
+    // ptmalloc: chunks are 16-byte aligned and carry an 8-byte header; blocks
+    // past the mmap threshold (128 KiB by default, but adaptive) are left alone.
+    if (bytes >= 128 * 1024) return bytes;
+    return std::max<std::size_t>(24, ((bytes + 8 + 15) & ~std::size_t{15}) - 8);
+#elif defined(__APPLE__)
+    // libmalloc: 16-byte quanta for tiny blocks, 512-byte quanta for small ones.
+    if (bytes <= 1008) return (bytes + 15) & ~std::size_t{15};
+    if (bytes <= 15 * 1024) return (bytes + 511) & ~std::size_t{511};
+    return bytes;
+#else
+    return (bytes <= 4096) ? ((bytes + 15) & ~std::size_t{15}) : bytes;
+#endif
+}
+
+// Where my::allocator gets its bytes. A backend provides
+//   static void* allocate(std::size_t bytes);
+//   static void deallocate(void* p, std::size_t bytes) noexcept;
+//   static std::size_t good_size(std::size_t bytes) noexcept;
+// where good_size is the usable size of a block of `bytes`.
+// See thread_cache.hpp for a thread-caching backend.
+struct new_delete_backend {
+    static void* allocate(std::size_t bytes) {
+        return ::operator new(bytes);
+    }
+
+    static void deallocate(void* p, std::size_t bytes) noexcept {
+        ::operator delete(p, bytes);
+    }
+
+    static constexpr std::size_t good_size(std::size_t bytes) noexcept {
+        return malloc_size_class(bytes);
+    }
+};
+
+template<class T, class Backend = new_delete_backend>
 class allocator {
 public:
     using value_type                             = T;
     using size_type                              = std::size_t;
     using difference_type                        = std::ptrdiff_t;
+    using propagate_on_container_copy_assignment = std::false_type;
     using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap            = std::false_type;
+    using is_always_equal                        = std::true_type;
 
     // constructors
     constexpr allocator() noexcept = default;
     constexpr allocator(const allocator&) noexcept : allocator() {}
     template<class U>
-    constexpr allocator(const allocator<U>&) noexcept : allocator() {}
+    constexpr allocator(const allocator<U, Backend>&) noexcept : allocator() {}
     // destructor
     constexpr ~allocator() = default;
 
+    constexpr allocator& operator=(const allocator&) noexcept = default;
+
+    constexpr size_type max_size() const noexcept {
+        return std::numeric_limits<difference_type>::max() / sizeof(T);
+    }
+
+    // Over-aligned types bypass the backend and use the align_val_t
+    // overloads of ::operator new. Constant evaluation can only use
+    // std::allocator.
     constexpr T* allocate(size_type n) {
-        return static_cast<T*>(::operator new(n * sizeof(T)));
+        if (n > max_size()) {
+            throw std::bad_array_new_length();
+        }
+        if consteval {
+            return std::allocator<T>{}.allocate(n);
+        }
+        if constexpr (over_aligned) {
+            return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t{alignof(T)}));
+        } else {
+            return static_cast<T*>(Backend::allocate(n * sizeof(T)));
+        }
     }
 
-    // constexpr std::allocation_result<T*, size_type>
-    // allocate_at_least(size_type n) {
-    //     return { allocate(n), n };
-    // }
-    
-    constexpr void deallocate(T* p) {
-        ::operator delete(p);
+    constexpr allocation_result<T*, size_type> allocate_at_least(size_type n) {
+        if consteval {
+            return { allocate(n), n };
+        }
+        if (over_aligned || n > max_size()) {
+            return { allocate(n), n };
+        }
+        size_type count = std::max(n, Backend::good_size(n * sizeof(T)) / sizeof(T));
+        return { allocate(count), count };
+    }
+
+    constexpr void deallocate(T* p)
+        requires std::same_as<Backend, new_delete_backend>
+    {
+        if constexpr (over_aligned) {
+            ::operator delete(p, std::align_val_t{alignof(T)});
+        } else {
+            ::operator delete(p);
+        }
     }
 
     constexpr void deallocate(T* p, size_type n) {
-        ::operator delete(p, n * sizeof(T));
+        if consteval {
+            std::allocator<T>{}.deallocate(p, n);
+            return;
+        }
+        if constexpr (over_aligned) {
+            ::operator delete(p, n * sizeof(T), std::align_val_t{alignof(T)});
+        } else {
+            Backend::deallocate(p, n * sizeof(T));
+        }
     }
+
+private:
+    static constexpr bool over_aligned = alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__;
 }; // class allocator
 
-template<class T1, class T2>
-constexpr bool operator==( const allocator<T1>&, const allocator<T2>&) noexcept {
+template<class T1, class T2, class Backend>
+constexpr bool operator==(const allocator<T1, Backend>&, const allocator<T2, Backend>&) noexcept {
     return true;
 }
 // impl allocator
 
+// Allocator whose blocks start on an Align-byte boundary (or alignof(T), if
+// larger), e.g. for SIMD loads on cache-line aligned data. The slack of
+// allocate_at_least pads the block to a whole number of alignment units.
+template<class T, std::size_t Align>
+class aligned_allocator {
+    static_assert(std::has_single_bit(Align), "alignment must be a power of two");
+public:
+    using value_type                             = T;
+    using size_type                              = std::size_t;
+    using difference_type                        = std::ptrdiff_t;
+    using propagate_on_container_move_assignment = std::true_type;
+    using is_always_equal                        = std::true_type;
+
+    static constexpr std::size_t alignment = std::max(Align, alignof(T));
+
+    // the non-type parameter keeps allocator_traits from rebinding on its own
+    template<class U>
+    struct rebind {
+        using other = aligned_allocator<U, Align>;
+    };
+
+    // constructors
+    constexpr aligned_allocator() noexcept = default;
+    template<class U>
+    constexpr aligned_allocator(const aligned_allocator<U, Align>&) noexcept {}
+
+    constexpr size_type max_size() const noexcept {
+        return (std::numeric_limits<difference_type>::max() - alignment) / sizeof(T);
+    }
+
+    T* allocate(size_type n) {
+        if (n > max_size()) {
+            throw std::bad_array_new_length();
+        }
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t{alignment}));
+    }
+
+    allocation_result<T*, size_type> allocate_at_least(size_type n) {
+        if (n > max_size()) {
+            throw std::bad_array_new_length();
+        }
+        size_type bytes = (n * sizeof(T) + alignment - 1) & ~(alignment - 1);
+        size_type count = std::max(n, bytes / sizeof(T));
+        return { allocate(count), count };
+    }
+
+    void deallocate(T* p, size_type n) noexcept {
+        ::operator delete(p, n * sizeof(T), std::align_val_t{alignment});
+    }
+}; // class aligned_allocator
+
+template<class T1, class T2, std::size_t Align>
+constexpr bool operator==(const aligned_allocator<T1, Align>&,
+                          const aligned_allocator<T2, Align>&) noexcept {
+    return true;
+}
+
+// Calls alloc.allocate_at_least(n) when the allocator provides it, so that
+// containers can use the slack of the returned block as capacity.
+template<class Alloc>
+constexpr auto allocate_at_least(Alloc& alloc, std::size_t n)
+    -> allocation_result<decltype(alloc.allocate(n)), std::size_t>
+{
+    if constexpr (requires { alloc.allocate_at_least(n); }) {
+        auto [ptr, count] = alloc.allocate_at_least(n);
+        return { ptr, static_cast<std::size_t>(count) };
+    } else {
+        return { alloc.allocate(n), n };
+    }
+}
+
+// Allocators that can resize a block themselves, keeping its bytes, and
+// report failure with a null pointer. See realloc_allocator.
+template<class Alloc>
+concept reallocating_allocator =
+    requires(Alloc& alloc, typename Alloc::value_type* p, std::size_t n) {
+        { alloc.reallocate(p, n, n) }
+            -> std::same_as<allocation_result<typename Alloc::value_type*, std::size_t>>;
+    };
+
+// Moves [first, last) into the uninitialized storage at d_first and ends the
+// lifetime of the source objects. Trivially relocatable types are copied in
+// one memcpy and never have their destructors run. The ranges must not overlap.
+template<class T>
+constexpr T* uninitialized_relocate(T* first, T* last, T* d_first) {
+    if constexpr (is_trivially_relocatable_v<T>) {
+        if !consteval {
+            std::ptrdiff_t count = last - first;
+            if (count > 0) {
+                std::memcpy(static_cast<void*>(d_first),
+                            static_cast<const void*>(first),
+                            static_cast<std::size_t>(count) * sizeof(T));
+            }
+            return d_first + count;
+        }
+    }
+    T* d_last = std::uninitialized_move(first, last, d_first);
+    std::destroy(first, last);
+    return d_last;
+}
+
 template<class T> struct default_delete {
     constexpr default_delete() noexcept = default;
 
@@ -227,10 +430,11 @@ public:
         }
     }
 
+    // swaps the deleters too, even when the pointers are equal
     void swap(unique_ptr& other) noexcept {
-        if (*this != other) {
-            std::swap(m_pair, other.m_pair);
-        }
+        using std::swap;
+        swap(get_deleter(), other.get_deleter());
+        swap(m_pair.get_second(), other.m_pair.get_second());
     }
 
     // Observers
@@ -259,6 +463,10 @@ public:
     }
 }; // class unique_ptr
 
+template<class T, class D>
+struct is_trivially_relocatable<unique_ptr<T, D>>
+    : std::bool_constant<is_trivially_relocatable_v<D>> {};
+
 // Non-member functions for unique_ptr
 template<class T, class... Args>
 constexpr unique_ptr<T> make_unique(Args&&... args)
@@ -274,6 +482,13 @@ constexpr unique_ptr<T> make_unique_for_overwrite()
     return unique_ptr<T>(new T);
 }
 
+template<class T, class D>
+void swap(unique_ptr<T, D>& lhs, unique_ptr<T, D>& rhs) noexcept
+    requires std::is_swappable_v<D>
+{
+    lhs.swap(rhs);
+}
+
 template<class T1, class D1, class T2, class D2>
 constexpr bool operator==(const unique_ptr<T1, D1>& x, const unique_ptr<T2, D2>& y) {
     return x.get() == y.get();
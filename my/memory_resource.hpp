@@ -0,0 +1,141 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <type_traits>
+
+namespace my {
+
+// Bump allocator over a chain of blocks taken from ::operator new. Memory
+// is only given back when the arena is released or destroyed, so a whole
+// graph of containers built in it is freed in one step. Blocks grow
+// geometrically; a request larger than the next block gets a block of its own.
+class monotonic_arena {
+    // header at the start of every block
+    struct block {
+        block* prev;
+        std::size_t size;
+    };
+    static constexpr std::size_t header_size =
+        (sizeof(block) + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+
+    block* m_head = nullptr;
+    std::byte* m_cur = nullptr;
+    std::byte* m_end = nullptr;
+    std::size_t m_next_size;
+
+public:
+    explicit monotonic_arena(std::size_t initial_size = 4096) noexcept :
+        m_next_size{std::max(initial_size, header_size + alignof(std::max_align_t))} {}
+
+    monotonic_arena(const monotonic_arena&) = delete;
+    monotonic_arena& operator=(const monotonic_arena&) = delete;
+
+    ~monotonic_arena() {
+        release();
+    }
+
+    void* allocate(std::size_t bytes, std::size_t align = alignof(std::max_align_t)) {
+        if (!fits(bytes, align)) {
+            grow(bytes, align);
+        }
+        auto aligned = align_up(m_cur, align);
+        m_cur = reinterpret_cast<std::byte*>(aligned + bytes);
+        return reinterpret_cast<void*>(aligned);
+    }
+
+    // nothing is reclaimed until release()
+    void deallocate(void*, std::size_t, std::size_t = alignof(std::max_align_t)) noexcept {}
+
+    // Frees every block. Containers still using the arena are left dangling.
+    void release() noexcept {
+        while (m_head != nullptr) {
+            block* prev = m_head->prev;
+            ::operator delete(static_cast<void*>(m_head), m_head->size);
+            m_head = prev;
+        }
+        m_cur = m_end = nullptr;
+    }
+
+    // bytes obtained from ::operator new, headers included
+    std::size_t footprint() const noexcept {
+        std::size_t total = 0;
+        for (block* b = m_head; b != nullptr; b = b->prev) {
+            total += b->size;
+        }
+        return total;
+    }
+
+private:
+    static std::uintptr_t align_up(std::byte* p, std::size_t align) noexcept {
+        auto addr = reinterpret_cast<std::uintptr_t>(p);
+        return (addr + align - 1) & ~std::uintptr_t{align - 1};
+    }
+
+    bool fits(std::size_t bytes, std::size_t align) const noexcept {
+        if (m_cur == nullptr) return false;
+        auto avail = static_cast<std::size_t>(m_end - m_cur);
+        auto padding = align_up(m_cur, align) - reinterpret_cast<std::uintptr_t>(m_cur);
+        return padding <= avail && bytes <= avail - padding;
+    }
+
+    void grow(std::size_t bytes, std::size_t align) {
+        if (bytes > std::numeric_limits<std::size_t>::max() / 2 - header_size - align) {
+            throw std::bad_alloc();
+        }
+        std::size_t size = std::max(m_next_size, header_size + bytes + align);
+        auto* b = static_cast<block*>(::operator new(size));
+        *b = block{m_head, size};
+        m_head = b;
+        m_cur = reinterpret_cast<std::byte*>(b) + header_size;
+        m_end = reinterpret_cast<std::byte*>(b) + size;
+        m_next_size = std::max(m_next_size, size / 2) * 2;
+    }
+}; // class monotonic_arena
+
+// Allocator handing out memory from a monotonic_arena; deallocate is a
+// no-op. Containers keep their arena: it is not propagated on copy, move
+// or swap, and containers in different arenas move element by element.
+template<class T>
+class arena_allocator {
+    monotonic_arena* m_arena;
+
+    template<class U> friend class arena_allocator;
+public:
+    using value_type                             = T;
+    using size_type                              = std::size_t;
+    using difference_type                        = std::ptrdiff_t;
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::false_type;
+    using propagate_on_container_swap            = std::false_type;
+    using is_always_equal                        = std::false_type;
+
+    // constructors
+    constexpr arena_allocator(monotonic_arena& arena) noexcept : m_arena{&arena} {}
+    template<class U>
+    constexpr arena_allocator(const arena_allocator<U>& other) noexcept : m_arena{other.m_arena} {}
+
+    constexpr size_type max_size() const noexcept {
+        return std::numeric_limits<difference_type>::max() / sizeof(T);
+    }
+
+    T* allocate(size_type n) {
+        if (n > max_size()) throw std::bad_array_new_length();
+        return static_cast<T*>(m_arena->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T*, size_type) noexcept {}
+
+    constexpr monotonic_arena* arena() const noexcept {
+        return m_arena;
+    }
+
+    template<class U>
+    constexpr bool operator==(const arena_allocator<U>& other) const noexcept {
+        return m_arena == other.m_arena;
+    }
+}; // class arena_allocator
+
+} // namespace my
@@ -0,0 +1,182 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <type_traits>
+#include "memory.hpp"
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace my {
+
+// Allocator for large buffers. Requests below Threshold bytes go to
+// my::allocator; larger ones are mapped directly, aligned to a huge page and
+// marked MADV_HUGEPAGE so that transparent huge pages can back them, which
+// cuts TLB misses on random access. With Populate, the pages are faulted in
+// up front instead of on first touch.
+template<class T, std::size_t Threshold = std::size_t{2} << 20, bool Populate = false>
+class mmap_allocator {
+public:
+    using value_type                             = T;
+    using size_type                              = std::size_t;
+    using difference_type                        = std::ptrdiff_t;
+    using propagate_on_container_move_assignment = std::true_type;
+    using is_always_equal                        = std::true_type;
+
+    // the non-type parameters keep allocator_traits from rebinding on its own
+    template<class U>
+    struct rebind {
+        using other = mmap_allocator<U, Threshold, Populate>;
+    };
+
+    static constexpr size_type huge_page_size = size_type{2} << 20;
+#if defined(__linux__)
+    static constexpr size_type mmap_threshold = Threshold;
+#else
+    static constexpr size_type mmap_threshold = std::numeric_limits<size_type>::max();
+#endif
+
+    static_assert(alignof(T) <= huge_page_size);
+
+    // constructors
+    constexpr mmap_allocator() noexcept = default;
+    template<class U>
+    constexpr mmap_allocator(const mmap_allocator<U, Threshold, Populate>&) noexcept {}
+
+    constexpr size_type max_size() const noexcept {
+        return std::numeric_limits<difference_type>::max() / sizeof(T);
+    }
+
+    T* allocate(size_type n) {
+        if (n > max_size()) throw std::bad_array_new_length();
+        if (!is_mapped(n * sizeof(T))) {
+            return allocator<T>{}.allocate(n);
+        }
+        return allocate_at_least(n).ptr;
+    }
+
+    allocation_result<T*, size_type> allocate_at_least(size_type n) {
+        if (n > max_size()) throw std::bad_array_new_length();
+
+        size_type bytes = n * sizeof(T);
+        if (!is_mapped(bytes)) {
+            // keeps heap blocks below the threshold, so deallocate can tell them apart
+            size_type count = std::clamp(malloc_size_class(bytes) / sizeof(T),
+                                         n, (mmap_threshold - 1) / sizeof(T));
+            return { allocator<T>{}.allocate(count), count };
+        }
+        bytes = round_to_huge_page(bytes);
+        void* p = map(bytes);
+        if (p == nullptr) throw std::bad_alloc();
+        return { static_cast<T*>(p), bytes / sizeof(T) };
+    }
+
+    void deallocate(T* p, size_type n) noexcept {
+        size_type bytes = n * sizeof(T);
+        if (is_mapped(bytes)) {
+            unmap(p, round_to_huge_page(bytes));
+        } else {
+            allocator<T>{}.deallocate(p, n);
+        }
+    }
+
+    // Resizes a mapped block with mremap, keeping its bytes. Heap blocks, and
+    // blocks that would cross the threshold, report failure with a null
+    // pointer and are left untouched.
+    allocation_result<T*, size_type> reallocate(T* p, size_type old_n, size_type new_n) noexcept {
+        if (new_n > max_size()) return { nullptr, 0 };
+
+        size_type old_bytes = old_n * sizeof(T);
+        size_type new_bytes = new_n * sizeof(T);
+        if (!is_mapped(old_bytes) || !is_mapped(new_bytes)) return { nullptr, 0 };
+
+        new_bytes = round_to_huge_page(new_bytes);
+        void* q = remap(p, round_to_huge_page(old_bytes), new_bytes);
+        if (q == nullptr) return { nullptr, 0 };
+        return { static_cast<T*>(q), new_bytes / sizeof(T) };
+    }
+
+private:
+    static constexpr bool is_mapped(size_type bytes) noexcept {
+        return bytes >= mmap_threshold;
+    }
+
+    static constexpr size_type round_to_huge_page(size_type bytes) noexcept {
+        return (bytes + huge_page_size - 1) & ~(huge_page_size - 1);
+    }
+
+#if defined(__linux__)
+    // Over-maps by one huge page and trims both ends, so that the block
+    // starts on a huge page boundary. Population has to wait for the advice:
+    // MAP_POPULATE would fault in the whole range as small pages first.
+    static void* map(size_type bytes) noexcept {
+        size_type mapped = bytes + huge_page_size;
+        void* p = ::mmap(nullptr, mapped, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) return nullptr;
+
+        auto addr = reinterpret_cast<std::uintptr_t>(p);
+        auto aligned = (addr + huge_page_size - 1) & ~std::uintptr_t{huge_page_size - 1};
+        size_type head = aligned - addr;
+        if (head > 0) {
+            ::munmap(p, head);
+        }
+        ::munmap(reinterpret_cast<void*>(aligned + bytes), huge_page_size - head);
+        advise(reinterpret_cast<void*>(aligned), bytes);
+        if constexpr (Populate) {
+            populate(reinterpret_cast<void*>(aligned), bytes);
+        }
+        return reinterpret_cast<void*>(aligned);
+    }
+
+    static void unmap(void* p, size_type bytes) noexcept {
+        ::munmap(p, bytes);
+    }
+
+    // mremap may move the block off a huge page boundary; the kernel then
+    // backs only its aligned middle with huge pages.
+    static void* remap(void* p, size_type old_bytes, size_type new_bytes) noexcept {
+        void* q = ::mremap(p, old_bytes, new_bytes, MREMAP_MAYMOVE);
+        if (q == MAP_FAILED) return nullptr;
+        advise(q, new_bytes);
+        if constexpr (Populate) {
+            populate(static_cast<char*>(q) + old_bytes, new_bytes - std::min(old_bytes, new_bytes));
+        }
+        return q;
+    }
+
+    static void advise([[maybe_unused]] void* p, [[maybe_unused]] size_type bytes) noexcept {
+#if defined(MADV_HUGEPAGE)
+        ::madvise(p, bytes, MADV_HUGEPAGE);
+#endif
+    }
+
+    // Faults the range in with MADV_POPULATE_WRITE, or by writing to each
+    // page on kernels older than 5.14. The pages are still zero either way.
+    static void populate(void* p, size_type bytes) noexcept {
+#if defined(MADV_POPULATE_WRITE)
+        if (::madvise(p, bytes, MADV_POPULATE_WRITE) == 0) return;
+#endif
+        auto* first = static_cast<volatile char*>(p);
+        for (size_type offset = 0; offset < bytes; offset += 4096) {
+            first[offset] = 0;
+        }
+    }
+#else
+    static void* map(size_type) noexcept { return nullptr; }
+    static void unmap(void*, size_type) noexcept {}
+    static void* remap(void*, size_type, size_type) noexcept { return nullptr; }
+#endif
+}; // class mmap_allocator
+
+template<class T1, class T2, std::size_t Threshold, bool Populate>
+constexpr bool operator==(const mmap_allocator<T1, Threshold, Populate>&,
+                          const mmap_allocator<T2, Threshold, Populate>&) noexcept {
+    return true;
+}
+
+} // namespace my
@@ -1,3 +1,4 @@
+#pragma once
 #include "utility.hpp"
 #include <concepts>
 #include <cstddef>
@@ -462,10 +463,26 @@ public:
     constexpr T&& unwrap_unchecked() && { return std::move(m_some); }
     constexpr const T&& unwrap_unchecked() const && { return std::move(m_some); }
 }; // class optional
+
+template<class T>
+struct is_trivially_relocatable<optional<T>>
+    : std::bool_constant<is_trivially_relocatable_v<T>> {};
 } // namespace my
 
 namespace std {
 
+// like std::optional: an engaged optional hashes as its value
+template<class T>
+    requires requires(const T& v) { hash<remove_const_t<T>>{}(v); }
+struct hash<my::optional<T>> {
+    constexpr size_t operator()(const my::optional<T>& o) const
+        noexcept(noexcept(hash<remove_const_t<T>>{}(o.unwrap_unchecked())))
+    {
+        return o.has_value() ? hash<remove_const_t<T>>{}(o.unwrap_unchecked())
+                             : static_cast<size_t>(0x9e3779b97f4a7c15ull);
+    }
+};
+
 template <class T>
 struct formatter<my::optional<T>> {
     constexpr auto parse(format_parse_context& ctx) {
@@ -0,0 +1,741 @@
+#pragma once
+#include <bit>
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <system_error>
+#include <type_traits>
+#include "optional.hpp"
+#include "power_of_five.hpp"
+#include "string_view.hpp"
+
+// Decimal numbers out of a string_view, with the grammar and results of
+// std::from_chars in base 10 and chars_format::general: an optional '-', no
+// '+' or leading whitespace, and for floats also "inf", "infinity" and
+// "nan" in any case. Floats are correctly rounded to nearest, ties to even.
+//
+// Digits are converted eight at a time from one 64-bit load (SWAR). A float
+// with at most 19 significant digits is then one exact multiply or divide
+// when both its mantissa and its power of ten are exact (Clinger's fast
+// path), and otherwise one or two 64x128-bit multiplies against a table of
+// powers of five (Eisel-Lemire), which always round right for such inputs.
+// Longer inputs are cut to 19 digits; only when the cut lands too close to
+// a halfway point between two floats are all the digits compared in big
+// integer arithmetic. Nothing allocates, and everything also works in
+// constant evaluation.
+
+namespace my {
+
+// How far parse_prefix got. On success, or with result_out_of_range, pos is
+// one past the number; with invalid_argument text did not start with one,
+// and pos is 0.
+struct parse_result {
+    std::size_t pos;
+    std::errc ec;
+
+    constexpr explicit operator bool() const noexcept {
+        return ec == std::errc{};
+    }
+};
+
+template<class T>
+concept parsable_number =
+    (std::integral<T> && !std::same_as<T, bool> && sizeof(T) <= 8) ||
+    std::same_as<T, float> || std::same_as<T, double>;
+
+namespace {
+
+constexpr bool is_digit(char c) noexcept {
+    return static_cast<unsigned char>(c - '0') < 10;
+}
+
+// the 8 chars at p, the first in the low byte
+constexpr std::uint64_t load_chars8(const char* p) noexcept {
+    if consteval {
+        std::uint64_t v = 0;
+        for (int i = 7; i >= 0; --i) {
+            v = (v << 8) | static_cast<unsigned char>(p[i]);
+        }
+        return v;
+    } else {
+        std::uint64_t v;
+        std::memcpy(&v, p, sizeof(v));
+        if constexpr (std::endian::native == std::endian::big) {
+            v = std::byteswap(v);
+        }
+        return v;
+    }
+}
+
+// Whether all eight bytes are '0'..'9': adding 0x46 carries into the high
+// bit of bytes above '9', subtracting 0x30 borrows into it below '0'.
+constexpr bool is_eight_digits(std::uint64_t v) noexcept {
+    return (((v + 0x4646464646464646ull) | (v - 0x3030303030303030ull)) & 0x8080808080808080ull) == 0;
+}
+
+// The value of eight digit chars, by combining neighbours into pairs, then
+// quads, then the whole: three multiplies instead of eight.
+constexpr std::uint32_t parse_eight_digits(std::uint64_t v) noexcept {
+    constexpr std::uint64_t mask = 0x000000ff000000ffull;
+    constexpr std::uint64_t mul1 = 100 + (1000000ull << 32);
+    constexpr std::uint64_t mul2 = 1 + (10000ull << 32);
+    v -= 0x3030303030303030ull;
+    v = (v * 10) + (v >> 8);
+    v = (((v & mask) * mul1) + (((v >> 16) & mask) * mul2)) >> 32;
+    return static_cast<std::uint32_t>(v);
+}
+
+// Appends the run of digits at p to acc and returns its end. acc wraps on
+// overflow; callers count the digits to tell.
+constexpr const char* accumulate_digits(const char* p, const char* end, std::uint64_t& acc) noexcept {
+    while (end - p >= 8) {
+        std::uint64_t v = load_chars8(p);
+        if (!is_eight_digits(v)) {
+            break;
+        }
+        acc = acc * 100000000 + parse_eight_digits(v);
+        p += 8;
+    }
+    while (p != end && is_digit(*p)) {
+        acc = acc * 10 + static_cast<std::uint64_t>(*p - '0');
+        ++p;
+    }
+    return p;
+}
+
+template<class T> struct float_format;
+
+template<> struct float_format<double> {
+    using bits_type = std::uint64_t;
+    static constexpr int mantissa_bits = 52;
+    static constexpr int minimum_exponent = -1023;
+    static constexpr int infinite_power = 0x7ff;
+    // below and above these, every 19-digit mantissa is 0 or infinity
+    static constexpr int smallest_power_of_ten = -342;
+    static constexpr int largest_power_of_ten = 308;
+    // where a product can be an exact halfway point between two floats
+    static constexpr int min_exponent_round_to_even = -4;
+    static constexpr int max_exponent_round_to_even = 23;
+    static constexpr int max_fast_exponent = 22;
+    static constexpr std::uint64_t max_fast_mantissa = std::uint64_t{2} << mantissa_bits;
+    static constexpr double exact_powers[] = {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+    };
+};
+
+template<> struct float_format<float> {
+    using bits_type = std::uint32_t;
+    static constexpr int mantissa_bits = 23;
+    static constexpr int minimum_exponent = -127;
+    static constexpr int infinite_power = 0xff;
+    static constexpr int smallest_power_of_ten = -64;
+    static constexpr int largest_power_of_ten = 38;
+    static constexpr int min_exponent_round_to_even = -17;
+    static constexpr int max_exponent_round_to_even = 10;
+    static constexpr int max_fast_exponent = 10;
+    static constexpr std::uint64_t max_fast_mantissa = std::uint64_t{2} << mantissa_bits;
+    static constexpr float exact_powers[] = {
+        1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f,
+    };
+};
+
+// The fields of a float: the mantissa without its implicit bit, and the
+// biased exponent.
+struct adjusted_mantissa {
+    std::uint64_t mantissa = 0;
+    int power2 = 0;
+
+    friend constexpr bool operator==(const adjusted_mantissa&, const adjusted_mantissa&) = default;
+};
+
+// A decimal float as mantissa * 10^exponent, where the mantissa holds the
+// first 19 significant digits and is truncated if there were more. The
+// digit spans are kept for when those are needed after all.
+struct decimal_number {
+    std::uint64_t mantissa = 0;
+    std::int64_t exponent = 0;
+    // the 'e' part alone
+    std::int64_t explicit_exponent = 0;
+    const char* int_first = nullptr;
+    const char* int_last = nullptr;
+    const char* frac_first = nullptr;
+    const char* frac_last = nullptr;
+    bool negative = false;
+    bool truncated = false;
+};
+
+inline constexpr std::uint64_t min_19_digit_integer = 1000000000000000000ull;
+
+// Parses [-]digits[.digits][(e|E)[+|-]digits] at p, with digits on at
+// least one side of the point. Returns one past it, or nullptr if there is
+// none. An 'e' without digits after it is not part of the number.
+constexpr const char* parse_decimal(const char* p, const char* end, decimal_number& d) noexcept {
+    d.negative = p != end && *p == '-';
+    if (d.negative) {
+        ++p;
+    }
+    std::uint64_t mantissa = 0;
+    d.int_first = p;
+    p = accumulate_digits(p, end, mantissa);
+    d.int_last = p;
+    std::int64_t digit_count = d.int_last - d.int_first;
+    std::int64_t exponent = 0;
+    d.frac_first = d.frac_last = p;
+    if (p != end && *p == '.') {
+        d.frac_first = ++p;
+        p = accumulate_digits(p, end, mantissa);
+        d.frac_last = p;
+        exponent = d.frac_first - d.frac_last;
+        digit_count -= exponent;
+    }
+    if (digit_count == 0) {
+        return nullptr;
+    }
+
+    d.explicit_exponent = 0;
+    if (p != end && (*p == 'e' || *p == 'E')) {
+        const char* q = p + 1;
+        bool negative = false;
+        if (q != end && (*q == '-' || *q == '+')) {
+            negative = *q == '-';
+            ++q;
+        }
+        if (q != end && is_digit(*q)) {
+            for (; q != end && is_digit(*q); ++q) {
+                // saturate far beyond any finite nonzero result
+                if (d.explicit_exponent < 0x10000000) {
+                    d.explicit_exponent = 10 * d.explicit_exponent + (*q - '0');
+                }
+            }
+            if (negative) {
+                d.explicit_exponent = -d.explicit_exponent;
+            }
+            p = q;
+        }
+    }
+    exponent += d.explicit_exponent;
+
+    d.truncated = false;
+    if (digit_count > 19) {
+        // leading zeros are not significant
+        const char* s = d.int_first;
+        for (; s != d.int_last && *s == '0'; ++s) {
+            --digit_count;
+        }
+        if (s == d.int_last) {
+            for (s = d.frac_first; s != d.frac_last && *s == '0'; ++s) {
+                --digit_count;
+            }
+        }
+        if (digit_count > 19) {
+            d.truncated = true;
+            mantissa = 0;
+            const char* q = d.int_first;
+            for (; mantissa < min_19_digit_integer && q != d.int_last; ++q) {
+                mantissa = mantissa * 10 + static_cast<std::uint64_t>(*q - '0');
+            }
+            if (mantissa >= min_19_digit_integer) {
+                exponent = (d.int_last - q) + d.explicit_exponent;
+            } else {
+                for (q = d.frac_first; mantissa < min_19_digit_integer && q != d.frac_last; ++q) {
+                    mantissa = mantissa * 10 + static_cast<std::uint64_t>(*q - '0');
+                }
+                exponent = (d.frac_first - q) + d.explicit_exponent;
+            }
+        }
+    }
+    d.mantissa = mantissa;
+    d.exponent = exponent;
+    return p;
+}
+
+// Eisel-Lemire: the float nearest w * 10^q, for any w and q. The product of
+// w and the 128-bit power of five has enough bits to round every 19-digit
+// w correctly (Mushtak and Lemire, "Fast number parsing without fallback");
+// the second multiply is only needed when the first leaves the rounding
+// bits all ones.
+template<class T>
+constexpr adjusted_mantissa eisel_lemire(std::int64_t q, std::uint64_t w) noexcept {
+    using F = float_format<T>;
+    adjusted_mantissa answer;
+    if (w == 0 || q < F::smallest_power_of_ten) {
+        return answer;
+    }
+    if (q > F::largest_power_of_ten) {
+        answer.power2 = F::infinite_power;
+        return answer;
+    }
+    int lz = std::countl_zero(w);
+    w <<= lz;
+
+    std::size_t index = 2 * static_cast<std::size_t>(q - smallest_power_of_five);
+    constexpr std::uint64_t precision_mask = ~std::uint64_t{0} >> (F::mantissa_bits + 3);
+    unsigned __int128 first = static_cast<unsigned __int128>(w) * power_of_five_128[index];
+    std::uint64_t high = static_cast<std::uint64_t>(first >> 64);
+    std::uint64_t low = static_cast<std::uint64_t>(first);
+    if ((high & precision_mask) == precision_mask) {
+        unsigned __int128 second = static_cast<unsigned __int128>(w) * power_of_five_128[index + 1];
+        std::uint64_t carry = static_cast<std::uint64_t>(second >> 64);
+        low += carry;
+        if (low < carry) {
+            ++high;
+        }
+    }
+
+    int upperbit = static_cast<int>(high >> 63);
+    int shift = upperbit + 64 - F::mantissa_bits - 3;
+    answer.mantissa = high >> shift;
+    // floor(log2(10^q)) + 63, from a fixed-point log2(10)
+    int power = static_cast<int>(((152170 + 65536) * q) >> 16) + 63;
+    answer.power2 = power + upperbit - lz - F::minimum_exponent;
+
+    if (answer.power2 <= 0) {
+        // subnormal
+        if (-answer.power2 + 1 >= 64) {
+            return {};
+        }
+        answer.mantissa >>= -answer.power2 + 1;
+        answer.mantissa += answer.mantissa & 1;
+        answer.mantissa >>= 1;
+        // rounding may carry into the smallest normal exponent
+        answer.power2 = answer.mantissa < (std::uint64_t{1} << F::mantissa_bits) ? 0 : 1;
+        return answer;
+    }
+
+    // An exact tie between two floats rounds to even; only small powers of
+    // ten can produce one, and then the low bits are zero.
+    if (low <= 1 && q >= F::min_exponent_round_to_even && q <= F::max_exponent_round_to_even &&
+        (answer.mantissa & 3) == 1 && (answer.mantissa << shift) == high) {
+        answer.mantissa &= ~std::uint64_t{1};
+    }
+    answer.mantissa += answer.mantissa & 1;
+    answer.mantissa >>= 1;
+    if (answer.mantissa >= (std::uint64_t{2} << F::mantissa_bits)) {
+        answer.mantissa = std::uint64_t{1} << F::mantissa_bits;
+        ++answer.power2;
+    }
+    answer.mantissa &= ~(std::uint64_t{1} << F::mantissa_bits);
+    if (answer.power2 >= F::infinite_power) {
+        return { 0, F::infinite_power };
+    }
+    return answer;
+}
+
+// Unsigned integer for the rare inputs that need all their digits. Sized
+// for the largest number the slow path builds: up to 801 digits divided by
+// up to 5^1143, plus a 66-bit quotient.
+struct big_uint {
+    static constexpr std::size_t capacity = 48;
+
+    // least significant first, no high zero limbs
+    std::uint64_t limbs[capacity]{};
+    std::size_t size = 0;
+
+    // *this = *this * m + a
+    constexpr void mul_add(std::uint64_t m, std::uint64_t a) noexcept {
+        std::uint64_t carry = a;
+        for (std::size_t i = 0; i < size; ++i) {
+            unsigned __int128 t = static_cast<unsigned __int128>(limbs[i]) * m + carry;
+            limbs[i] = static_cast<std::uint64_t>(t);
+            carry = static_cast<std::uint64_t>(t >> 64);
+        }
+        if (carry != 0) {
+            assert(size < capacity && "big_uint overflow");
+            limbs[size++] = carry;
+        }
+    }
+
+    constexpr void shift_left(std::size_t bits) noexcept {
+        if (size == 0) {
+            return;
+        }
+        std::size_t words = bits / 64;
+        unsigned rem = bits % 64;
+        std::uint64_t top = rem != 0 ? limbs[size - 1] >> (64 - rem) : 0;
+        assert(size + words + (top != 0) <= capacity && "big_uint overflow");
+        if (top != 0) {
+            limbs[size + words] = top;
+        }
+        for (std::size_t i = size; i-- > 0;) {
+            std::uint64_t v = limbs[i] << rem;
+            if (rem != 0 && i > 0) {
+                v |= limbs[i - 1] >> (64 - rem);
+            }
+            limbs[i + words] = v;
+        }
+        for (std::size_t i = 0; i < words; ++i) {
+            limbs[i] = 0;
+        }
+        size += words + (top != 0);
+    }
+
+    constexpr void shift_right_one() noexcept {
+        for (std::size_t i = 0; i < size; ++i) {
+            limbs[i] = (limbs[i] >> 1) | (i + 1 < size ? limbs[i + 1] << 63 : 0);
+        }
+        if (size > 0 && limbs[size - 1] == 0) {
+            --size;
+        }
+    }
+
+    // *this -= other, which is not larger
+    constexpr void subtract(const big_uint& other) noexcept {
+        std::uint64_t borrow = 0;
+        for (std::size_t i = 0; i < size; ++i) {
+            std::uint64_t b = i < other.size ? other.limbs[i] : 0;
+            std::uint64_t d = limbs[i] - b - borrow;
+            borrow = (limbs[i] < b || (limbs[i] == b && borrow != 0)) ? 1 : 0;
+            limbs[i] = d;
+        }
+        while (size > 0 && limbs[size - 1] == 0) {
+            --size;
+        }
+    }
+
+    constexpr std::size_t bit_length() const noexcept {
+        return size == 0 ? 0 : 64 * (size - 1) + std::bit_width(limbs[size - 1]);
+    }
+
+    // the 64 bits from bit pos up
+    constexpr std::uint64_t bits_from(std::size_t pos) const noexcept {
+        std::size_t word = pos / 64;
+        unsigned rem = pos % 64;
+        std::uint64_t v = limbs[word] >> rem;
+        if (rem != 0 && word + 1 < size) {
+            v |= limbs[word + 1] << (64 - rem);
+        }
+        return v;
+    }
+
+    // whether any bit below pos is set
+    constexpr bool any_below(std::size_t pos) const noexcept {
+        std::size_t word = pos / 64;
+        for (std::size_t i = 0; i < word; ++i) {
+            if (limbs[i] != 0) {
+                return true;
+            }
+        }
+        return pos % 64 != 0 && (limbs[word] & ((std::uint64_t{1} << (pos % 64)) - 1)) != 0;
+    }
+
+    friend constexpr bool operator<(const big_uint& lhs, const big_uint& rhs) noexcept {
+        if (lhs.size != rhs.size) {
+            return lhs.size < rhs.size;
+        }
+        for (std::size_t i = lhs.size; i-- > 0;) {
+            if (lhs.limbs[i] != rhs.limbs[i]) {
+                return lhs.limbs[i] < rhs.limbs[i];
+            }
+        }
+        return false;
+    }
+}; // struct big_uint
+
+// *big *= base^n, with base^step the largest power to fit in 64 bits
+constexpr void multiply_power(big_uint& big, std::uint64_t base, int step, std::int64_t n) noexcept {
+    std::uint64_t big_power = 1;
+    for (int i = 0; i < step; ++i) {
+        big_power *= base;
+    }
+    for (; n >= step; n -= step) {
+        big.mul_add(big_power, 0);
+    }
+    std::uint64_t power = 1;
+    for (; n > 0; --n) {
+        power *= base;
+    }
+    big.mul_add(power, 0);
+}
+
+// Rounds top * 2^e2 to nearest even, where top has its high bit set and
+// sticky says whether anything nonzero was cut off below it.
+template<class T>
+constexpr adjusted_mantissa round_to_float(std::uint64_t top, std::int64_t e2, bool sticky) noexcept {
+    using F = float_format<T>;
+    std::int64_t power2 = e2 + 63 - F::minimum_exponent;
+    std::int64_t shift = 63 - F::mantissa_bits;
+    if (power2 <= 0) {
+        // subnormal: fewer mantissa bits survive
+        shift += 1 - power2;
+        power2 = 0;
+    }
+    if (shift > 64) {
+        return {};
+    }
+    unsigned __int128 wide = top;
+    std::uint64_t mantissa = static_cast<std::uint64_t>(wide >> shift);
+    unsigned __int128 rest = wide & ((static_cast<unsigned __int128>(1) << shift) - 1);
+    unsigned __int128 half = static_cast<unsigned __int128>(1) << (shift - 1);
+    if (rest > half || (rest == half && (sticky || (mantissa & 1) != 0))) {
+        ++mantissa;
+    }
+    if (power2 == 0) {
+        // a carry into the implicit bit makes the smallest normal
+        bool normal = mantissa >> F::mantissa_bits != 0;
+        return { mantissa & ~(std::uint64_t{1} << F::mantissa_bits), normal ? 1 : 0 };
+    }
+    if (mantissa == (std::uint64_t{2} << F::mantissa_bits)) {
+        mantissa >>= 1;
+        ++power2;
+    }
+    if (power2 >= F::infinite_power) {
+        return { 0, F::infinite_power };
+    }
+    return { mantissa & ~(std::uint64_t{1} << F::mantissa_bits), static_cast<int>(power2) };
+}
+
+// The correctly rounded float of all of d's digits, in big integer
+// arithmetic. Digits past the 800th only matter for whether they are all
+// zero, since no halfway point between two floats has that many.
+template<class T>
+constexpr adjusted_mantissa exact_float(const decimal_number& d) noexcept {
+    using F = float_format<T>;
+    constexpr std::int64_t max_digits = 800;
+
+    big_uint big;
+    std::int64_t digits = 0;
+    std::int64_t exponent = d.explicit_exponent - (d.frac_last - d.frac_first);
+    std::uint64_t chunk = 0;
+    int chunk_digits = 0;
+    bool nonzero_rest = false;
+    auto take = [&](const char* first, const char* last) {
+        for (const char* p = first; p != last; ++p) {
+            if (digits == 0 && *p == '0') {
+                continue;
+            }
+            if (digits == max_digits) {
+                nonzero_rest = nonzero_rest || *p != '0';
+                ++exponent;
+                continue;
+            }
+            chunk = chunk * 10 + static_cast<std::uint64_t>(*p - '0');
+            ++digits;
+            if (++chunk_digits == 19) {
+                big.mul_add(10000000000000000000ull, chunk);
+                chunk = 0;
+                chunk_digits = 0;
+            }
+        }
+    };
+    take(d.int_first, d.int_last);
+    take(d.frac_first, d.frac_last);
+    std::uint64_t chunk_scale = 1;
+    for (int i = 0; i < chunk_digits; ++i) {
+        chunk_scale *= 10;
+    }
+    big.mul_add(chunk_scale, chunk);
+    if (nonzero_rest) {
+        // a 1 just past the kept digits stands in for the rest
+        big.mul_add(10, 1);
+        ++digits;
+        --exponent;
+    }
+
+    if (digits == 0 || digits + exponent < F::smallest_power_of_ten) {
+        return {};
+    }
+    if (digits + exponent > F::largest_power_of_ten + 1) {
+        return { 0, F::infinite_power };
+    }
+
+    if (exponent >= 0) {
+        multiply_power(big, 10, 19, exponent);
+        std::size_t length = big.bit_length();
+        if (length <= 64) {
+            return round_to_float<T>(big.limbs[0] << (64 - length), static_cast<std::int64_t>(length) - 64, false);
+        }
+        return round_to_float<T>(big.bits_from(length - 64), static_cast<std::int64_t>(length) - 64,
+                                 big.any_below(length - 64));
+    }
+
+    // big / 10^k = (big * 2^s / 5^k) * 2^(-s - k), with s picked so the
+    // quotient has 65 or 66 bits, found one bit at a time
+    std::int64_t k = -exponent;
+    big_uint divisor;
+    divisor.mul_add(0, 1);
+    multiply_power(divisor, 5, 27, k);
+    std::int64_t s = 66 + static_cast<std::int64_t>(divisor.bit_length()) - static_cast<std::int64_t>(big.bit_length());
+    if (s >= 0) {
+        big.shift_left(static_cast<std::size_t>(s));
+    } else {
+        divisor.shift_left(static_cast<std::size_t>(-s));
+    }
+    divisor.shift_left(66);
+    unsigned __int128 quotient = 0;
+    for (int i = 66; i >= 0; --i) {
+        quotient <<= 1;
+        if (!(big < divisor)) {
+            big.subtract(divisor);
+            quotient |= 1;
+        }
+        divisor.shift_right_one();
+    }
+    bool sticky = big.size != 0;
+    // the quotient is at least 2^64: keep its top 64 bits
+    int extra = static_cast<int>(std::bit_width(static_cast<std::uint64_t>(quotient >> 64)));
+    sticky = sticky || (quotient & ((static_cast<unsigned __int128>(1) << extra) - 1)) != 0;
+    std::uint64_t top = static_cast<std::uint64_t>(quotient >> extra);
+    return round_to_float<T>(top, extra - s - k, sticky);
+}
+
+template<class T>
+constexpr T make_float(bool negative, adjusted_mantissa am) noexcept {
+    using bits_type = typename float_format<T>::bits_type;
+    std::uint64_t bits = am.mantissa | (static_cast<std::uint64_t>(am.power2) << float_format<T>::mantissa_bits);
+    if (negative) {
+        bits |= std::uint64_t{1} << (8 * sizeof(T) - 1);
+    }
+    return std::bit_cast<T>(static_cast<bits_type>(bits));
+}
+
+// whether p starts with lower, ignoring the case of p's letters
+constexpr bool starts_with_nocase(const char* p, const char* end, string_view lower) noexcept {
+    if (static_cast<std::size_t>(end - p) < lower.size()) {
+        return false;
+    }
+    for (std::size_t i = 0; i < lower.size(); ++i) {
+        if ((p[i] | 0x20) != lower[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// [-]inf, [-]infinity, [-]nan or [-]nan(chars)
+template<class T>
+constexpr parse_result parse_special(const char* first, const char* end, T& value) noexcept {
+    const char* p = first;
+    bool negative = p != end && *p == '-';
+    if (negative) {
+        ++p;
+    }
+    if (starts_with_nocase(p, end, "nan")) {
+        p += 3;
+        if (p != end && *p == '(') {
+            const char* q = p + 1;
+            while (q != end && (is_digit(*q) || ((*q | 0x20) >= 'a' && (*q | 0x20) <= 'z') || *q == '_')) {
+                ++q;
+            }
+            if (q != end && *q == ')') {
+                p = q + 1;
+            }
+        }
+        value = negative ? -std::numeric_limits<T>::quiet_NaN() : std::numeric_limits<T>::quiet_NaN();
+        return { static_cast<std::size_t>(p - first), std::errc{} };
+    }
+    if (starts_with_nocase(p, end, "inf")) {
+        p += starts_with_nocase(p, end, "infinity") ? 8 : 3;
+        value = negative ? -std::numeric_limits<T>::infinity() : std::numeric_limits<T>::infinity();
+        return { static_cast<std::size_t>(p - first), std::errc{} };
+    }
+    return { 0, std::errc::invalid_argument };
+}
+
+} // anonymous namespace
+
+// Parses the integer at the start of text, in base 10, into value; value is
+// left alone unless the result is a success.
+template<class T>
+    requires parsable_number<T> && std::integral<T>
+constexpr parse_result parse_prefix(string_view text, T& value) noexcept {
+    const char* first = text.data();
+    const char* end = first + text.size();
+    const char* p = first;
+    bool negative = false;
+    if constexpr (std::is_signed_v<T>) {
+        if (p != end && *p == '-') {
+            negative = true;
+            ++p;
+        }
+    }
+    const char* digits = p;
+    while (p != end && *p == '0') {
+        ++p;
+    }
+    const char* significant = p;
+    std::uint64_t magnitude = 0;
+    p = accumulate_digits(p, end, magnitude);
+    if (p == digits) {
+        return { 0, std::errc::invalid_argument };
+    }
+    std::size_t pos = static_cast<std::size_t>(p - first);
+
+    // Twenty digits fit only from 1 followed by at least nineteen zeros
+    // up, and any wrapped sum of those is below 10^19.
+    std::ptrdiff_t count = p - significant;
+    bool overflow = count > 20 ||
+        (count == 20 && (*significant != '1' || magnitude < 10000000000000000000ull));
+    using U = std::make_unsigned_t<T>;
+    std::uint64_t limit = std::numeric_limits<U>::max();
+    if constexpr (std::is_signed_v<T>) {
+        limit = static_cast<std::uint64_t>(std::numeric_limits<T>::max()) + (negative ? 1 : 0);
+    }
+    if (overflow || magnitude > limit) {
+        return { pos, std::errc::result_out_of_range };
+    }
+    value = negative ? static_cast<T>(U{0} - static_cast<U>(magnitude)) : static_cast<T>(magnitude);
+    return { pos, std::errc{} };
+}
+
+// Parses the float at the start of text into value, rounded to nearest. A
+// finite number too large for T, or nonzero but too small for its smallest
+// subnormal, is result_out_of_range; value is then left alone.
+template<class T>
+    requires parsable_number<T> && std::floating_point<T>
+constexpr parse_result parse_prefix(string_view text, T& value) noexcept {
+    using F = float_format<T>;
+    const char* first = text.data();
+    const char* end = first + text.size();
+    decimal_number d;
+    const char* p = parse_decimal(first, end, d);
+    if (p == nullptr) {
+        return parse_special(first, end, value);
+    }
+    std::size_t pos = static_cast<std::size_t>(p - first);
+
+    if (!d.truncated && d.exponent >= -F::max_fast_exponent && d.exponent <= F::max_fast_exponent &&
+        d.mantissa <= F::max_fast_mantissa) {
+        // both exact, so one rounding
+        T v = static_cast<T>(d.mantissa);
+        v = d.exponent < 0 ? v / F::exact_powers[-d.exponent] : v * F::exact_powers[d.exponent];
+        value = d.negative ? -v : v;
+        return { pos, std::errc{} };
+    }
+
+    adjusted_mantissa am = eisel_lemire<T>(d.exponent, d.mantissa);
+    // the digits cut off put the value between the truncated mantissa and
+    // the next one up; if those round apart, look at every digit
+    if (d.truncated && am != eisel_lemire<T>(d.exponent, d.mantissa + 1)) {
+        am = exact_float<T>(d);
+    }
+    if (am.power2 == F::infinite_power || (am.power2 == 0 && am.mantissa == 0 && d.mantissa != 0)) {
+        return { pos, std::errc::result_out_of_range };
+    }
+    value = make_float<T>(d.negative, am);
+    return { pos, std::errc{} };
+}
+
+// The number that is all of text, or nothing. On failure, *error_pos (if
+// given) is where parsing stopped: the first char after the number, or 0
+// when text does not start with a number or it is out of range.
+//
+//     my::parse<int>("-42") == -42, my::parse<double>("1e-3") == 0.001
+//     my::parse<int>("42 ") is empty, with *error_pos == 2
+template<parsable_number T>
+constexpr optional<T> parse(string_view text, std::size_t* error_pos = nullptr) noexcept {
+    T value{};
+    parse_result result = parse_prefix(text, value);
+    if (result && result.pos == text.size()) {
+        return value;
+    }
+    if (error_pos != nullptr) {
+        *error_pos = result ? result.pos : 0;
+    }
+    return std::nullopt;
+}
+
+} // namespace my
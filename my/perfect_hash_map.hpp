@@ -0,0 +1,212 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include "hash.hpp"
+#include "string_view.hpp"
+#include "utility.hpp"
+
+namespace my {
+
+// Immutable map from a fixed set of string keys, built in constant
+// evaluation by make_perfect_hash_map. The keys are placed with hash and
+// displace: each key's hash picks a bucket, and every bucket has a pilot
+// chosen so that its keys land on slots no other key uses. A lookup hashes
+// the key once, mixes in the pilot of its bucket to get the slot, and
+// compares the key stored there; there is no probing.
+//
+// Entries are kept, and iterated, in the order they were given.
+template<class Value, std::size_t N>
+class perfect_hash_map {
+    static_assert(N > 0, "perfect_hash_map needs at least one key");
+
+public:
+    using key_type       = string_view;
+    using mapped_type    = Value;
+    using value_type     = pair<string_view, Value>;
+    using size_type      = std::size_t;
+    using const_iterator = const value_type*;
+
+    // Slots at most half full, and a bucket for every four keys or so. A
+    // fuller table is smaller but needs far more pilot attempts to build,
+    // which counts against the compiler's constant evaluation limit.
+    static constexpr size_type slot_count = std::bit_ceil(std::max<size_type>(2 * N, 2));
+    static constexpr size_type bucket_count = (N + 3) / 4;
+
+private:
+    using index_type = std::conditional_t<(N < 0xffff), std::uint16_t, std::uint32_t>;
+    static constexpr index_type empty_slot = static_cast<index_type>(N);
+    static constexpr int slot_shift = 64 - std::countr_zero(slot_count);
+
+    std::array<value_type, N> m_entries;
+    std::array<std::uint64_t, bucket_count> m_pilots{};
+    std::array<index_type, slot_count> m_slots{};
+    std::uint64_t m_seed = 0;
+
+    template<class V, std::size_t M>
+    friend constexpr perfect_hash_map<V, M>
+        make_perfect_hash_map(const std::array<pair<string_view, V>, M>&);
+
+    constexpr explicit perfect_hash_map(const std::array<value_type, N>& entries) :
+        m_entries{entries} {}
+
+public:
+    constexpr const_iterator find(string_view key) const noexcept {
+        std::uint64_t h = hash_bytes(key.data(), key.size(), m_seed);
+        index_type i = m_slots[slot_of(h, m_pilots[bucket_of(h)])];
+        if (i != empty_slot && m_entries[i].first == key) {
+            return &m_entries[i];
+        }
+        return end();
+    }
+
+    constexpr bool contains(string_view key) const noexcept {
+        return find(key) != end();
+    }
+
+    constexpr const Value& at(string_view key) const {
+        const_iterator it = find(key);
+        if (it == end()) {
+            throw std::out_of_range("Key not found");
+        }
+        return it->second;
+    }
+
+    constexpr const_iterator begin() const noexcept {
+        return m_entries.data();
+    }
+
+    constexpr const_iterator end() const noexcept {
+        return m_entries.data() + N;
+    }
+
+    constexpr size_type size() const noexcept {
+        return N;
+    }
+
+private:
+    static constexpr size_type bucket_of(std::uint64_t h) noexcept {
+        return static_cast<size_type>(((h >> 32) * bucket_count) >> 32);
+    }
+
+    // the top bits of the product depend on every bit of h ^ pilot
+    static constexpr size_type slot_of(std::uint64_t h, std::uint64_t pilot) noexcept {
+        return static_cast<size_type>(((h ^ pilot) * 0x9e3779b97f4a7c15ull) >> slot_shift);
+    }
+
+    static constexpr std::uint64_t pilot_of(std::uint64_t attempt) noexcept {
+        return hash_combine(attempt, 0);
+    }
+
+    // Places every bucket, the largest first, under the current seed.
+    // Returns false when some bucket finds no pilot, to retry with another
+    // seed.
+    constexpr bool place(const std::array<std::uint64_t, N>& hashes) {
+        std::array<index_type, N> bucket_keys{};
+        std::array<size_type, bucket_count + 1> bucket_start{};
+        for (std::uint64_t h : hashes) {
+            ++bucket_start[bucket_of(h) + 1];
+        }
+        for (size_type b = 0; b < bucket_count; ++b) {
+            bucket_start[b + 1] += bucket_start[b];
+        }
+        std::array<size_type, bucket_count> fill{};
+        for (size_type i = 0; i < N; ++i) {
+            size_type b = bucket_of(hashes[i]);
+            bucket_keys[bucket_start[b] + fill[b]++] = static_cast<index_type>(i);
+        }
+
+        std::array<size_type, bucket_count> order{};
+        for (size_type b = 0; b < bucket_count; ++b) {
+            order[b] = b;
+        }
+        std::sort(order.begin(), order.end(), [&](size_type a, size_type b) {
+            return bucket_start[a + 1] - bucket_start[a] > bucket_start[b + 1] - bucket_start[b];
+        });
+
+        m_slots.fill(empty_slot);
+        for (size_type b : order) {
+            size_type first = bucket_start[b];
+            size_type last = bucket_start[b + 1];
+            if (first == last) {
+                break;
+            }
+            bool placed = false;
+            for (std::uint64_t attempt = 0; attempt < 4 * slot_count && !placed; ++attempt) {
+                std::uint64_t pilot = pilot_of(attempt);
+                size_type k = first;
+                for (; k < last; ++k) {
+                    size_type slot = slot_of(hashes[bucket_keys[k]], pilot);
+                    if (m_slots[slot] != empty_slot) {
+                        break;
+                    }
+                    m_slots[slot] = bucket_keys[k];
+                }
+                if (k == last) {
+                    m_pilots[b] = pilot;
+                    placed = true;
+                } else {
+                    // undo the keys of this bucket placed so far
+                    while (k-- > first) {
+                        m_slots[slot_of(hashes[bucket_keys[k]], pilot)] = empty_slot;
+                    }
+                }
+            }
+            if (!placed) {
+                return false;
+            }
+        }
+        return true;
+    }
+}; // class perfect_hash_map
+
+// Builds a perfect_hash_map over `entries`, which must have distinct keys.
+// Meant for constant evaluation:
+//
+//     constexpr auto commands = my::make_perfect_hash_map<int>({
+//         {"GET", 1}, {"SET", 2}, {"DEL", 3},
+//     });
+template<class Value, std::size_t N>
+constexpr perfect_hash_map<Value, N>
+    make_perfect_hash_map(const std::array<pair<string_view, Value>, N>& entries)
+{
+    perfect_hash_map<Value, N> map{entries};
+    const auto& copy = map.m_entries;
+
+    std::array<std::uint64_t, N> hashes{};
+    std::array<std::size_t, N> by_hash{};
+    for (std::uint64_t seed = 0; seed < 64; ++seed) {
+        for (std::size_t i = 0; i < N; ++i) {
+            hashes[i] = hash_bytes(copy[i].first.data(), copy[i].first.size(), seed);
+            by_hash[i] = i;
+        }
+        // keys with equal hashes cannot be told apart by any pilot
+        std::sort(by_hash.begin(), by_hash.end(),
+                  [&](std::size_t a, std::size_t b) { return hashes[a] < hashes[b]; });
+        bool distinct = true;
+        for (std::size_t i = 1; i < N && distinct; ++i) {
+            if (hashes[by_hash[i - 1]] == hashes[by_hash[i]]) {
+                if (copy[by_hash[i - 1]].first == copy[by_hash[i]].first) {
+                    throw std::invalid_argument("Duplicate key in perfect_hash_map");
+                }
+                distinct = false;
+            }
+        }
+        if (distinct && map.place(hashes)) {
+            map.m_seed = seed;
+            return map;
+        }
+    }
+    throw std::logic_error("No perfect hash found for the keys");
+}
+
+template<class Value, std::size_t N>
+constexpr perfect_hash_map<Value, N> make_perfect_hash_map(const pair<string_view, Value> (&entries)[N]) {
+    return make_perfect_hash_map(std::to_array(entries));
+}
+
+} // namespace my
@@ -0,0 +1,135 @@
+#pragma once
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include "memory.hpp"
+#include "thread_cache.hpp"
+
+namespace my {
+
+namespace {
+
+inline constexpr std::size_t pool_granularity = alignof(std::max_align_t);
+inline constexpr std::size_t max_pooled_size = small_class_limit;
+
+} // anonymous namespace
+
+// Stateless allocator that serves single objects of up to 256 bytes from
+// the per-thread free lists of thread_cache.hpp, so a thread only locks the
+// central pool of its size class once per batch of blocks. Arrays and
+// larger or over-aligned types go to ::operator new.
+template<class T>
+class pool_allocator {
+public:
+    using value_type                             = T;
+    using size_type                              = std::size_t;
+    using difference_type                        = std::ptrdiff_t;
+    using propagate_on_container_move_assignment = std::true_type;
+    using is_always_equal                        = std::true_type;
+
+    static constexpr bool pooled =
+        sizeof(T) <= max_pooled_size && alignof(T) <= pool_granularity;
+
+    // constructors
+    constexpr pool_allocator() noexcept = default;
+    template<class U>
+    constexpr pool_allocator(const pool_allocator<U>&) noexcept {}
+
+    constexpr size_type max_size() const noexcept {
+        return std::numeric_limits<difference_type>::max() / sizeof(T);
+    }
+
+    T* allocate(size_type n) {
+        if constexpr (pooled) {
+            if (n == 1) {
+                return static_cast<T*>(thread_cache_backend::allocate(block_size));
+            }
+        }
+        return allocator<T>{}.allocate(n);
+    }
+
+    void deallocate(T* p, size_type n) noexcept {
+        if constexpr (pooled) {
+            if (n == 1) {
+                thread_cache_backend::deallocate(p, block_size);
+                return;
+            }
+        }
+        allocator<T>{}.deallocate(p, n);
+    }
+
+private:
+    static constexpr std::size_t block_size =
+        (sizeof(T) + pool_granularity - 1) & ~(pool_granularity - 1);
+}; // class pool_allocator
+
+template<class T1, class T2>
+constexpr bool operator==(const pool_allocator<T1>&, const pool_allocator<T2>&) noexcept {
+    return true;
+}
+
+// Deleter for objects made by allocate_unique: destroys the object and
+// returns its block to the allocator. For empty allocators the deleter is
+// empty too, so unique_ptr stays one pointer wide; other allocators are
+// stored in the deleter.
+template<class Alloc,
+         bool Stateless = std::is_empty_v<Alloc> && std::default_initializable<Alloc>>
+class allocator_delete {
+    using alloc_traits = std::allocator_traits<Alloc>;
+    Alloc m_alloc;
+public:
+    using pointer = typename alloc_traits::pointer;
+
+    constexpr allocator_delete(const Alloc& alloc) noexcept : m_alloc{alloc} {}
+
+    constexpr Alloc get_allocator() const noexcept {
+        return m_alloc;
+    }
+
+    constexpr void operator()(pointer p) {
+        alloc_traits::destroy(m_alloc, std::to_address(p));
+        alloc_traits::deallocate(m_alloc, p, 1);
+    }
+};
+
+template<class Alloc>
+class allocator_delete<Alloc, true> {
+    using alloc_traits = std::allocator_traits<Alloc>;
+public:
+    using pointer = typename alloc_traits::pointer;
+
+    constexpr allocator_delete() noexcept = default;
+    constexpr allocator_delete(const Alloc&) noexcept {}
+
+    constexpr Alloc get_allocator() const noexcept {
+        return Alloc{};
+    }
+
+    constexpr void operator()(pointer p) const {
+        Alloc alloc{};
+        alloc_traits::destroy(alloc, std::to_address(p));
+        alloc_traits::deallocate(alloc, p, 1);
+    }
+};
+
+// Like make_unique, but the object lives in memory from alloc (rebound to T).
+template<class T, class Alloc, class... Args>
+auto allocate_unique(const Alloc& alloc, Args&&... args)
+    -> unique_ptr<T, allocator_delete<typename std::allocator_traits<Alloc>::template rebind_alloc<T>>>
+    requires (!std::is_array_v<T>)
+{
+    using rebound = typename std::allocator_traits<Alloc>::template rebind_alloc<T>;
+    using traits = std::allocator_traits<rebound>;
+    rebound a{alloc};
+    auto p = traits::allocate(a, 1);
+    try {
+        traits::construct(a, std::to_address(p), std::forward<Args>(args)...);
+    } catch (...) {
+        traits::deallocate(a, p, 1);
+        throw;
+    }
+    return { p, allocator_delete<rebound>{a} };
+}
+
+} // namespace my
@@ -0,0 +1,161 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <limits>
+#include <new>
+#include <type_traits>
+#include "memory.hpp"
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#elif defined(__APPLE__)
+#include <malloc/malloc.h>
+#endif
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace my {
+
+namespace {
+
+inline std::size_t malloc_usable_bytes(void* p, std::size_t requested) noexcept {
+#if defined(__GLIBC__)
+    return std::max(requested, ::malloc_usable_size(p));
+#elif defined(__APPLE__)
+    return std::max(requested, ::malloc_size(p));
+#else
+    (void)p;
+    return requested;
+#endif
+}
+
+} // anonymous namespace
+
+// Allocator on top of malloc/realloc that lets a container resize a block
+// without moving its elements one by one. On Linux, blocks of at least
+// mmap_threshold bytes are mapped directly and resized with mremap, which
+// remaps pages instead of copying them.
+template<class T>
+class realloc_allocator {
+public:
+    using value_type                             = T;
+    using size_type                              = std::size_t;
+    using difference_type                        = std::ptrdiff_t;
+    using propagate_on_container_move_assignment = std::true_type;
+    using is_always_equal                        = std::true_type;
+
+#if defined(__linux__)
+    static constexpr size_type mmap_threshold = size_type{1} << 20;
+#else
+    static constexpr size_type mmap_threshold = std::numeric_limits<size_type>::max();
+#endif
+
+    static_assert(alignof(T) <= alignof(std::max_align_t),
+                  "realloc does not preserve extended alignment");
+
+    // constructors
+    constexpr realloc_allocator() noexcept = default;
+    template<class U>
+    constexpr realloc_allocator(const realloc_allocator<U>&) noexcept {}
+
+    constexpr size_type max_size() const noexcept {
+        return std::numeric_limits<difference_type>::max() / sizeof(T);
+    }
+
+    T* allocate(size_type n) {
+        return allocate_at_least(n).ptr;
+    }
+
+    allocation_result<T*, size_type> allocate_at_least(size_type n) {
+        if (n == 0) return { nullptr, 0 };
+        if (n > max_size()) throw std::bad_array_new_length();
+
+        size_type bytes = n * sizeof(T);
+        void* p = nullptr;
+        if (is_mapped(bytes)) {
+            bytes = round_to_page(bytes);
+            p = map(bytes);
+        } else if ((p = std::malloc(bytes))) {
+            bytes = usable_bytes(p, bytes);
+        }
+        if (p == nullptr) throw std::bad_alloc();
+        return { static_cast<T*>(p), bytes / sizeof(T) };
+    }
+
+    void deallocate(T* p, size_type n) noexcept {
+        size_type bytes = n * sizeof(T);
+        if (is_mapped(bytes)) {
+            unmap(p, round_to_page(bytes));
+        } else {
+            std::free(p);
+        }
+    }
+
+    // Resizes the block at p from old_n to new_n elements, keeping its bytes.
+    // The block may move. On failure the result is null and p is untouched.
+    allocation_result<T*, size_type> reallocate(T* p, size_type old_n, size_type new_n) noexcept {
+        if (new_n == 0 || new_n > max_size()) return { nullptr, 0 };
+
+        size_type old_bytes = old_n * sizeof(T);
+        size_type new_bytes = new_n * sizeof(T);
+        void* q = nullptr;
+        if (is_mapped(old_bytes) != is_mapped(new_bytes)) {
+            return { nullptr, 0 };
+        } else if (is_mapped(new_bytes)) {
+            new_bytes = round_to_page(new_bytes);
+            q = remap(p, round_to_page(old_bytes), new_bytes);
+        } else if ((q = std::realloc(p, new_bytes))) {
+            new_bytes = usable_bytes(q, new_bytes);
+        }
+        if (q == nullptr) return { nullptr, 0 };
+        return { static_cast<T*>(q), new_bytes / sizeof(T) };
+    }
+
+private:
+    static constexpr bool is_mapped(size_type bytes) noexcept {
+        return bytes >= mmap_threshold;
+    }
+
+    // keeps malloc'd blocks below the threshold, so deallocate can tell them apart
+    static size_type usable_bytes(void* p, size_type bytes) noexcept {
+        return std::min(malloc_usable_bytes(p, bytes), mmap_threshold - 1);
+    }
+
+#if defined(__linux__)
+    static size_type round_to_page(size_type bytes) noexcept {
+        static const size_type page = static_cast<size_type>(::sysconf(_SC_PAGESIZE));
+        return (bytes + page - 1) & ~(page - 1);
+    }
+
+    static void* map(size_type bytes) noexcept {
+        void* p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        return (p == MAP_FAILED) ? nullptr : p;
+    }
+
+    static void unmap(void* p, size_type bytes) noexcept {
+        ::munmap(p, bytes);
+    }
+
+    static void* remap(void* p, size_type old_bytes, size_type new_bytes) noexcept {
+        void* q = ::mremap(p, old_bytes, new_bytes, MREMAP_MAYMOVE);
+        return (q == MAP_FAILED) ? nullptr : q;
+    }
+#else
+    static size_type round_to_page(size_type bytes) noexcept { return bytes; }
+    static void* map(size_type) noexcept { return nullptr; }
+    static void unmap(void*, size_type) noexcept {}
+    static void* remap(void*, size_type, size_type) noexcept { return nullptr; }
+#endif
+}; // class realloc_allocator
+
+template<class T1, class T2>
+constexpr bool operator==(const realloc_allocator<T1>&, const realloc_allocator<T2>&) noexcept {
+    return true;
+}
+
+} // namespace my
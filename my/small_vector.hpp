@@ -0,0 +1,59 @@
+#pragma once
+#include <cstddef>
+#include "growth_policy.hpp"
+#include "memory.hpp"
+#include "vector_base.hpp"
+
+namespace my {
+
+// Storage of my::small_vector: room for N elements inside the object,
+// left uninitialized until the vector constructs them.
+template<class T, std::size_t N>
+struct inline_storage {
+    static constexpr std::size_t capacity = N;
+
+    union {
+        T m_buf[N];
+    };
+
+    constexpr inline_storage() noexcept {}
+    constexpr ~inline_storage() {}
+    inline_storage(const inline_storage&) = delete;
+    inline_storage& operator=(const inline_storage&) = delete;
+
+    constexpr T* data() noexcept {
+        return m_buf;
+    }
+
+    constexpr const T* data() const noexcept {
+        return m_buf;
+    }
+};
+
+// A vector that keeps up to N elements inline and only spills to memory
+// from Allocator beyond that. The API follows my::vector; iterators and
+// references are also invalidated when the elements move between inline
+// and heap storage.
+template<
+    class T,
+    std::size_t N,
+    class Allocator = allocator<T>,
+    class GrowthPolicy = doubling_growth
+> class small_vector : public vector_base<T, Allocator, GrowthPolicy, inline_storage<T, N>> {
+    static_assert(N > 0, "small_vector needs at least one inline element, use my::vector");
+    using base = vector_base<T, Allocator, GrowthPolicy, inline_storage<T, N>>;
+public:
+    static constexpr typename base::size_type inline_capacity = N;
+
+    using base::base;
+    using base::operator=;
+    using base::is_inline;
+}; // class small_vector
+
+template<class T, std::size_t N, class Alloc, class Growth>
+constexpr void swap(small_vector<T, N, Alloc, Growth>& lhs,
+                    small_vector<T, N, Alloc, Growth>& rhs) noexcept {
+    lhs.swap(rhs);
+}
+
+} // namespace my
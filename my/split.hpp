@@ -0,0 +1,270 @@
+#pragma once
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <iterator>
+#include <ranges>
+#include <string>
+#include <type_traits>
+#include "string_search.hpp"
+#include "string_view.hpp"
+
+namespace my {
+
+// Where a delimiter matches in text at or after pos, and how many chars it
+// covers; pos is npos when there is no further match.
+struct delimiter_match {
+    std::size_t pos;
+    std::size_t size;
+};
+
+// Delimiters of basic_split_view. Each keeps only views of its chars, which
+// must outlive the split.
+
+template<class CharT, class Traits = std::char_traits<CharT>>
+class char_delimiter {
+    CharT m_ch{};
+
+public:
+    constexpr char_delimiter() noexcept = default;
+    constexpr explicit char_delimiter(CharT ch) noexcept : m_ch{ch} {}
+
+    constexpr delimiter_match match(basic_string_view<CharT, Traits> text, std::size_t pos) const noexcept {
+        return { text.find(m_ch, pos), 1 };
+    }
+};
+
+template<class CharT, class Traits = std::char_traits<CharT>>
+class string_delimiter {
+    basic_string_view<CharT, Traits> m_str;
+
+public:
+    constexpr string_delimiter() noexcept = default;
+    constexpr explicit string_delimiter(basic_string_view<CharT, Traits> str) noexcept : m_str{str} {
+        assert(!str.empty() && "Split on an empty delimiter");
+    }
+
+    constexpr delimiter_match match(basic_string_view<CharT, Traits> text, std::size_t pos) const noexcept {
+        return { text.find(m_str, pos), m_str.size() };
+    }
+};
+
+// Any one char of a set. For plain chars the set is classified once, when
+// the delimiter is built, and each scan goes straight to the set kernel.
+template<class CharT, class Traits = std::char_traits<CharT>>
+class char_set {
+    static constexpr bool byte_search =
+        std::same_as<CharT, char> && std::same_as<Traits, std::char_traits<char>>;
+
+    basic_string_view<CharT, Traits> m_chars;
+    [[no_unique_address]] std::conditional_t<byte_search, byte_set, std::nullptr_t> m_set{};
+
+public:
+    constexpr char_set() noexcept = default;
+    constexpr explicit char_set(basic_string_view<CharT, Traits> chars) noexcept : m_chars{chars} {
+        if constexpr (byte_search) {
+            m_set = byte_set(chars.data(), chars.size());
+        }
+    }
+
+    constexpr delimiter_match match(basic_string_view<CharT, Traits> text, std::size_t pos) const noexcept {
+        if constexpr (byte_search) {
+            if !consteval {
+                if (pos >= text.size()) {
+                    return { text.npos, 1 };
+                }
+                const char* found = find_in_set(text.data() + pos, text.size() - pos, m_set, true);
+                return { found ? static_cast<std::size_t>(found - text.data()) : text.npos, 1 };
+            }
+        }
+        return { text.find_first_of(m_chars, pos), 1 };
+    }
+};
+
+constexpr char_set<char> any_of(string_view chars) noexcept {
+    return char_set<char>(chars);
+}
+
+// A char, a string or a char_set.
+template<class D, class CharT, class Traits>
+concept split_delimiter =
+    std::same_as<D, CharT> || std::same_as<D, char_set<CharT, Traits>> ||
+    std::convertible_to<const D&, basic_string_view<CharT, Traits>>;
+
+template<class CharT, class Traits, class D>
+    requires split_delimiter<D, CharT, Traits>
+constexpr auto make_delimiter(const D& delim) noexcept {
+    if constexpr (std::same_as<D, CharT>) {
+        return char_delimiter<CharT, Traits>(delim);
+    } else if constexpr (std::same_as<D, char_set<CharT, Traits>>) {
+        return delim;
+    } else {
+        return string_delimiter<CharT, Traits>(basic_string_view<CharT, Traits>(delim));
+    }
+}
+
+// Lazy range of the pieces of a string between delimiters. Each piece is a
+// view into the text, found only when the iterator reaches it; nothing is
+// copied or allocated. Follows std::views::split: an empty text has no
+// pieces, and a delimiter at either end gives an empty piece there.
+// tokenize() drops every empty piece instead.
+//
+// With a quote char, delimiters between a pair of quotes do not split, so a
+// CSV field like "a, b" stays whole. Pieces keep their quotes, since
+// removing escaped ones would need a copy. An unclosed quote runs to the end
+// of the text.
+template<class CharT, class Traits, class Delimiter>
+class basic_split_view
+    : public std::ranges::view_interface<basic_split_view<CharT, Traits, Delimiter>> {
+public:
+    using view_type = basic_string_view<CharT, Traits>;
+    using size_type = std::size_t;
+
+    static constexpr size_type npos = view_type::npos;
+
+    class iterator {
+        friend class basic_split_view;
+
+        const basic_split_view* m_parent = nullptr;
+        // npos once past the last piece
+        size_type m_start = npos;
+        size_type m_end = npos;
+        // start of the next piece, npos if this is the last
+        size_type m_next = npos;
+
+        constexpr explicit iterator(const basic_split_view* parent) noexcept : m_parent{parent} {}
+
+    public:
+        using value_type        = view_type;
+        using difference_type   = std::ptrdiff_t;
+        using iterator_concept  = std::forward_iterator_tag;
+        // pieces are returned by value
+        using iterator_category = std::input_iterator_tag;
+
+        constexpr iterator() noexcept = default;
+
+        constexpr view_type operator*() const noexcept {
+            return view_type(m_parent->m_text.data() + m_start, m_end - m_start);
+        }
+
+        constexpr iterator& operator++() noexcept {
+            m_parent->next_piece(*this);
+            return *this;
+        }
+
+        constexpr iterator operator++(int) noexcept {
+            iterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        friend constexpr bool operator==(const iterator& lhs, const iterator& rhs) noexcept {
+            return lhs.m_start == rhs.m_start;
+        }
+    };
+
+private:
+    view_type m_text;
+    Delimiter m_delim;
+    CharT m_quote{};
+    bool m_quoted = false;
+    bool m_skip_empty = false;
+
+public:
+    // constructors
+    constexpr basic_split_view() noexcept = default;
+
+    constexpr basic_split_view(view_type text, Delimiter delim, bool skip_empty = false) noexcept :
+        m_text{text}, m_delim{delim}, m_skip_empty{skip_empty} {}
+
+    constexpr basic_split_view(view_type text, Delimiter delim, CharT quote, bool skip_empty = false) noexcept :
+        m_text{text}, m_delim{delim}, m_quote{quote}, m_quoted{true}, m_skip_empty{skip_empty} {}
+
+    // Finds the first piece, so this is linear in its length.
+    constexpr iterator begin() const noexcept {
+        iterator it{this};
+        if (!m_text.empty()) {
+            it.m_next = 0;
+            next_piece(it);
+        }
+        return it;
+    }
+
+    constexpr iterator end() const noexcept {
+        return iterator{this};
+    }
+
+    constexpr view_type base() const noexcept {
+        return m_text;
+    }
+
+private:
+    // Moves it to the piece starting at it.m_next, skipping empty pieces
+    // when asked to, or past the end.
+    constexpr void next_piece(iterator& it) const noexcept {
+        do {
+            if (it.m_next == npos) {
+                it.m_start = it.m_end = npos;
+                return;
+            }
+            delimiter_match m = match_from(it.m_next);
+            it.m_start = it.m_next;
+            if (m.pos == npos) {
+                it.m_end = m_text.size();
+                it.m_next = npos;
+            } else {
+                it.m_end = m.pos;
+                it.m_next = m.pos + m.size;
+            }
+        } while (m_skip_empty && it.m_start == it.m_end);
+    }
+
+    // the next delimiter at or after pos that is not inside quotes
+    constexpr delimiter_match match_from(size_type pos) const noexcept {
+        delimiter_match m = m_delim.match(m_text, pos);
+        if (!m_quoted) {
+            return m;
+        }
+        while (true) {
+            size_type open = m_text.find(m_quote, pos);
+            if (open == npos || (m.pos != npos && m.pos < open)) {
+                return m;
+            }
+            size_type close = m_text.find(m_quote, open + 1);
+            if (close == npos) {
+                return { npos, 0 };
+            }
+            pos = close + 1;
+            if (m.pos != npos && m.pos < pos) {
+                m = m_delim.match(m_text, pos);
+            }
+        }
+    }
+}; // class basic_split_view
+
+// my::split(line, ',') / split(line, ", ") / split(line, any_of(" \t"))
+template<class CharT, class Traits, class D>
+    requires split_delimiter<D, CharT, Traits>
+constexpr auto split(basic_string_view<CharT, Traits> text, const D& delim) noexcept {
+    using delimiter_type = decltype(make_delimiter<CharT, Traits>(delim));
+    return basic_split_view<CharT, Traits, delimiter_type>(text, make_delimiter<CharT, Traits>(delim));
+}
+
+// Like split, without empty pieces: runs of delimiters count as one.
+template<class CharT, class Traits, class D>
+    requires split_delimiter<D, CharT, Traits>
+constexpr auto tokenize(basic_string_view<CharT, Traits> text, const D& delim) noexcept {
+    using delimiter_type = decltype(make_delimiter<CharT, Traits>(delim));
+    return basic_split_view<CharT, Traits, delimiter_type>(text, make_delimiter<CharT, Traits>(delim), true);
+}
+
+// Like split, leaving delimiters between quotes alone, e.g. for CSV.
+template<class CharT, class Traits, class D>
+    requires split_delimiter<D, CharT, Traits>
+constexpr auto split_quoted(basic_string_view<CharT, Traits> text, const D& delim,
+                            std::type_identity_t<CharT> quote = CharT('"')) noexcept {
+    using delimiter_type = decltype(make_delimiter<CharT, Traits>(delim));
+    return basic_split_view<CharT, Traits, delimiter_type>(text, make_delimiter<CharT, Traits>(delim), quote);
+}
+
+} // namespace my
@@ -0,0 +1,1011 @@
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <climits>
+#include <compare>
+#include <cstddef>
+#include <format>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include "memory.hpp"
+#include "string_view.hpp"
+#include "utility.hpp"
+
+namespace my {
+
+// A string that is three words wide and keeps short contents in the object
+// itself: up to inline_capacity chars (22 for char on 64-bit targets) never
+// touch the allocator. Longer contents live in a buffer from Allocator,
+// sized with allocate_at_least and grown by doubling. The contents are
+// always followed by a null char.
+//
+// The last byte of the object tells the two layouts apart. Inline, it holds
+// the size, which is below 0x80; on the heap, the encoded capacity sets its
+// top bit. In constant evaluation every string is on the heap.
+template<
+    class CharT,
+    class Traits = std::char_traits<CharT>,
+    class Allocator = allocator<CharT>
+> class basic_string {
+public:
+    using traits_type            = Traits;
+    using value_type             = CharT;
+    using allocator_type         = Allocator;
+    using size_type              = std::size_t;
+    using difference_type        = std::ptrdiff_t;
+    using reference              = value_type&;
+    using const_reference        = const value_type&;
+    using pointer                = value_type*;
+    using const_pointer          = const value_type*;
+    using iterator               = value_type*;
+    using const_iterator         = const value_type*;
+    using reverse_iterator       = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+    using view_type              = basic_string_view<CharT, Traits>;
+
+    static constexpr size_type npos = static_cast<size_type>(-1);
+
+private:
+    using alloc_traits = std::allocator_traits<Allocator>;
+
+    struct long_rep {
+        pointer data;
+        size_type size;
+        // capacity, excluding the null char, in encode_capacity form
+        size_type cap;
+    };
+
+    static constexpr size_type short_slots = (sizeof(long_rep) - 1) / sizeof(CharT);
+    static constexpr size_type tail_size = sizeof(long_rep) - short_slots * sizeof(CharT);
+
+    struct short_rep {
+        CharT data[short_slots];
+        // the size sits in the last byte
+        unsigned char tail[tail_size];
+    };
+
+    union rep {
+        long_rep l;
+        short_rep s;
+    };
+    static_assert(sizeof(short_rep) == sizeof(long_rep));
+
+    static constexpr unsigned char long_flag = 0x80;
+    // the byte of long_rep::cap that overlaps the last byte of the object
+    static constexpr unsigned flag_shift =
+        (std::endian::native == std::endian::little) ? CHAR_BIT * (sizeof(size_type) - 1) : 0;
+    static constexpr unsigned cap_shift =
+        (std::endian::native == std::endian::little) ? 0 : CHAR_BIT;
+
+    rep m_rep;
+    [[no_unique_address]] allocator_type m_alloc;
+
+public:
+    // chars held without allocating
+    static constexpr size_type inline_capacity = short_slots - 1;
+    static_assert(inline_capacity < long_flag);
+
+    // constructors
+    constexpr basic_string() noexcept(noexcept(Allocator())) : basic_string(Allocator()) {}
+
+    constexpr explicit basic_string(const Allocator& alloc) noexcept : m_alloc{alloc} {
+        set_empty();
+    }
+
+    constexpr basic_string(size_type count, CharT ch, const Allocator& alloc = Allocator()) :
+        m_alloc{alloc}
+    {
+        Traits::assign(init(count), count, ch);
+    }
+
+    constexpr basic_string(const CharT* s, size_type count, const Allocator& alloc = Allocator()) :
+        m_alloc{alloc}
+    {
+        Traits::copy(init(count), s, count);
+    }
+
+    constexpr basic_string(const CharT* s, const Allocator& alloc = Allocator()) :
+        basic_string(s, Traits::length(s), alloc) {}
+
+    basic_string(std::nullptr_t) = delete;
+
+    template<class InputIt>
+    constexpr basic_string(InputIt first, InputIt last, const Allocator& alloc = Allocator())
+        requires std::input_iterator<InputIt>
+    : m_alloc{alloc}
+    {
+        if constexpr (std::forward_iterator<InputIt>) {
+            size_type count = static_cast<size_type>(std::distance(first, last));
+            std::copy(first, last, init(count));
+        } else {
+            set_empty();
+            for (; first != last; ++first) {
+                push_back(*first);
+            }
+        }
+    }
+
+    constexpr explicit basic_string(view_type view, const Allocator& alloc = Allocator()) :
+        basic_string(view.data(), view.size(), alloc) {}
+
+    constexpr basic_string(std::initializer_list<CharT> ilist, const Allocator& alloc = Allocator()) :
+        basic_string(ilist.begin(), ilist.size(), alloc) {}
+
+    constexpr basic_string(const basic_string& other) :
+        basic_string(other, alloc_traits::select_on_container_copy_construction(other.m_alloc)) {}
+
+    constexpr basic_string(const basic_string& other, const Allocator& alloc) :
+        basic_string(other.data(), other.size(), alloc) {}
+
+    constexpr basic_string(basic_string&& other) noexcept :
+        m_rep{other.m_rep}, m_alloc{std::move(other.m_alloc)}
+    {
+        other.set_empty();
+    }
+
+    // Steals the buffer when alloc can free it, copies the chars otherwise.
+    constexpr basic_string(basic_string&& other, const Allocator& alloc) : basic_string(alloc) {
+        if (alloc_traits::is_always_equal::value || m_alloc == other.m_alloc) {
+            take_storage(other);
+        } else {
+            assign(other.data(), other.size());
+        }
+    }
+
+    constexpr allocator_type get_allocator() const noexcept {
+        return m_alloc;
+    }
+
+    // destructor
+    constexpr ~basic_string() {
+        release();
+    }
+
+    // assignment
+    constexpr basic_string& operator=(const basic_string& other) {
+        if (this == &other) {
+            return *this;
+        }
+        if constexpr (alloc_traits::propagate_on_container_copy_assignment::value) {
+            if (!alloc_traits::is_always_equal::value && m_alloc != other.m_alloc) {
+                // the old buffer can only go back to the old allocator
+                release();
+                set_empty();
+            }
+            m_alloc = other.m_alloc;
+        }
+        return assign(other.data(), other.size());
+    }
+
+    constexpr basic_string& operator=(basic_string&& other)
+        noexcept(alloc_traits::propagate_on_container_move_assignment::value ||
+                 alloc_traits::is_always_equal::value)
+    {
+        if (this == &other) {
+            return *this;
+        }
+        if (alloc_traits::propagate_on_container_move_assignment::value ||
+            alloc_traits::is_always_equal::value || m_alloc == other.m_alloc) {
+            take_storage(other);
+            if constexpr (alloc_traits::propagate_on_container_move_assignment::value) {
+                m_alloc = std::move(other.m_alloc);
+            }
+        } else {
+            // a buffer from another allocator cannot be adopted
+            assign(other.data(), other.size());
+        }
+        return *this;
+    }
+
+    constexpr basic_string& operator=(const CharT* s) {
+        return assign(s, Traits::length(s));
+    }
+
+    basic_string& operator=(std::nullptr_t) = delete;
+
+    constexpr basic_string& operator=(CharT ch) {
+        return assign(1, ch);
+    }
+
+    constexpr basic_string& operator=(view_type view) {
+        return assign(view.data(), view.size());
+    }
+
+    constexpr basic_string& operator=(std::initializer_list<CharT> ilist) {
+        return assign(ilist.begin(), ilist.size());
+    }
+
+    constexpr basic_string& assign(size_type count, CharT ch) {
+        if (count > capacity()) {
+            replace_with(allocate_for(count), 0);
+        }
+        Traits::assign(data(), count, ch);
+        set_size(count);
+        return *this;
+    }
+
+    // s may point into *this.
+    constexpr basic_string& assign(const CharT* s, size_type count) {
+        if (count <= capacity()) {
+            Traits::move(data(), s, count);
+            set_size(count);
+        } else {
+            auto new_buf = allocate_for(count);
+            Traits::copy(new_buf.ptr, s, count);
+            replace_with(new_buf, count);
+        }
+        return *this;
+    }
+
+    constexpr basic_string& assign(const CharT* s) {
+        return assign(s, Traits::length(s));
+    }
+
+    constexpr basic_string& assign(view_type view) {
+        return assign(view.data(), view.size());
+    }
+
+    constexpr basic_string& assign(const basic_string& other) {
+        return *this = other;
+    }
+
+    constexpr basic_string& assign(basic_string&& other) {
+        return *this = std::move(other);
+    }
+
+    template<class InputIt>
+    constexpr basic_string& assign(InputIt first, InputIt last)
+        requires std::input_iterator<InputIt>
+    {
+        return *this = basic_string(first, last, m_alloc);
+    }
+
+    constexpr basic_string& assign(std::initializer_list<CharT> ilist) {
+        return assign(ilist.begin(), ilist.size());
+    }
+
+    // element access
+    constexpr reference at(size_type pos) {
+        if (pos >= size()) {
+            throw std::out_of_range("Index out of range");
+        }
+        return data()[pos];
+    }
+
+    constexpr const_reference at(size_type pos) const {
+        if (pos >= size()) {
+            throw std::out_of_range("Index out of range");
+        }
+        return data()[pos];
+    }
+
+    constexpr reference operator[](size_type pos) {
+        return data()[pos];
+    }
+
+    constexpr const_reference operator[](size_type pos) const {
+        return data()[pos];
+    }
+
+    constexpr reference front() {
+        return data()[0];
+    }
+
+    constexpr const_reference front() const {
+        return data()[0];
+    }
+
+    constexpr reference back() {
+        return data()[size() - 1];
+    }
+
+    constexpr const_reference back() const {
+        return data()[size() - 1];
+    }
+
+    constexpr pointer data() noexcept {
+        return is_long() ? m_rep.l.data : m_rep.s.data;
+    }
+
+    constexpr const_pointer data() const noexcept {
+        return is_long() ? m_rep.l.data : m_rep.s.data;
+    }
+
+    constexpr const_pointer c_str() const noexcept {
+        return data();
+    }
+
+    constexpr operator view_type() const noexcept {
+        return view_type(data(), size());
+    }
+
+    // iterators
+    constexpr iterator begin() noexcept {
+        return data();
+    }
+
+    constexpr const_iterator begin() const noexcept {
+        return data();
+    }
+
+    constexpr const_iterator cbegin() const noexcept {
+        return data();
+    }
+
+    constexpr iterator end() noexcept {
+        return data() + size();
+    }
+
+    constexpr const_iterator end() const noexcept {
+        return data() + size();
+    }
+
+    constexpr const_iterator cend() const noexcept {
+        return data() + size();
+    }
+
+    constexpr reverse_iterator rbegin() noexcept {
+        return reverse_iterator(end());
+    }
+
+    constexpr const_reverse_iterator rbegin() const noexcept {
+        return const_reverse_iterator(end());
+    }
+
+    constexpr const_reverse_iterator crbegin() const noexcept {
+        return const_reverse_iterator(end());
+    }
+
+    constexpr reverse_iterator rend() noexcept {
+        return reverse_iterator(begin());
+    }
+
+    constexpr const_reverse_iterator rend() const noexcept {
+        return const_reverse_iterator(begin());
+    }
+
+    constexpr const_reverse_iterator crend() const noexcept {
+        return const_reverse_iterator(begin());
+    }
+
+    // capacity
+    constexpr bool empty() const noexcept {
+        return size() == 0;
+    }
+
+    constexpr size_type size() const noexcept {
+        return is_long() ? m_rep.l.size : m_rep.s.tail[tail_size - 1];
+    }
+
+    constexpr size_type length() const noexcept {
+        return size();
+    }
+
+    constexpr size_type max_size() const noexcept {
+        // the encoded capacity gives up its top byte to the flag
+        return std::min<size_type>({alloc_traits::max_size(m_alloc) - 1,
+                                    std::numeric_limits<difference_type>::max() / sizeof(CharT) - 1,
+                                    (size_type{1} << (CHAR_BIT * (sizeof(size_type) - 1))) - 1});
+    }
+
+    constexpr void reserve(size_type new_cap) {
+        if (new_cap > max_size()) {
+            throw std::length_error("Try to allocate space larger than max_size()");
+        } else if (new_cap > capacity()) {
+            grow_to(new_cap);
+        }
+    }
+
+    constexpr size_type capacity() const noexcept {
+        return is_long() ? decode_capacity(m_rep.l.cap) : inline_capacity;
+    }
+
+    // Moves the contents inline when they fit, or to a buffer sized for them.
+    constexpr void shrink_to_fit() {
+        if (!is_long()) {
+            return;
+        }
+        long_rep old = m_rep.l;
+        if (fits_inline(old.size)) {
+            set_empty();
+            Traits::copy(m_rep.s.data, old.data, old.size);
+            set_size(old.size);
+            m_alloc.deallocate(old.data, decode_capacity(old.cap) + 1);
+        } else if (old.size < decode_capacity(old.cap)) {
+            auto new_buf = my::allocate_at_least(m_alloc, old.size + 1);
+            if (new_buf.count - 1 < decode_capacity(old.cap)) {
+                Traits::copy(new_buf.ptr, old.data, old.size);
+                replace_with(new_buf, old.size);
+            } else {
+                m_alloc.deallocate(new_buf.ptr, new_buf.count);
+            }
+        }
+    }
+
+    // modifiers
+    constexpr void clear() noexcept {
+        set_size(0);
+    }
+
+    constexpr void push_back(CharT ch) {
+        append(&ch, 1);
+    }
+
+    constexpr void pop_back() {
+        assert(!empty() && "pop_back on an empty string");
+        set_size(size() - 1);
+    }
+
+    // s may point into *this.
+    constexpr basic_string& append(const CharT* s, size_type count) {
+        // one layout test on the way to the common cases; the fields are
+        // read before the chars are written, which may alias them
+        if (is_long()) {
+            pointer p = m_rep.l.data;
+            size_type sz = m_rep.l.size;
+            if (count <= decode_capacity(m_rep.l.cap) - sz) {
+                Traits::copy(p + sz, s, count);
+                p[sz + count] = CharT();
+                m_rep.l.size = sz + count;
+                return *this;
+            }
+        } else {
+            size_type sz = m_rep.s.tail[tail_size - 1];
+            if (count <= inline_capacity - sz) {
+                Traits::copy(m_rep.s.data + sz, s, count);
+                set_short_size(sz + count);
+                return *this;
+            }
+        }
+        return append_to_new_buffer(s, count);
+    }
+
+    constexpr basic_string& append(size_type count, CharT ch) {
+        size_type sz = size();
+        if (count > capacity() - sz) {
+            grow_to(next_capacity(count));
+        }
+        Traits::assign(data() + sz, count, ch);
+        set_size(sz + count);
+        return *this;
+    }
+
+    constexpr basic_string& append(const CharT* s) {
+        return append(s, Traits::length(s));
+    }
+
+    constexpr basic_string& append(view_type view) {
+        return append(view.data(), view.size());
+    }
+
+    constexpr basic_string& append(const basic_string& str) {
+        return append(str.data(), str.size());
+    }
+
+    template<class InputIt>
+    constexpr basic_string& append(InputIt first, InputIt last)
+        requires std::input_iterator<InputIt>
+    {
+        if constexpr (std::forward_iterator<InputIt>) {
+            basic_string tmp(first, last, m_alloc);
+            return append(tmp.data(), tmp.size());
+        } else {
+            for (; first != last; ++first) {
+                push_back(*first);
+            }
+            return *this;
+        }
+    }
+
+    constexpr basic_string& append(std::initializer_list<CharT> ilist) {
+        return append(ilist.begin(), ilist.size());
+    }
+
+    constexpr basic_string& operator+=(const basic_string& str) {
+        return append(str.data(), str.size());
+    }
+
+    constexpr basic_string& operator+=(view_type view) {
+        return append(view.data(), view.size());
+    }
+
+    constexpr basic_string& operator+=(const CharT* s) {
+        return append(s, Traits::length(s));
+    }
+
+    constexpr basic_string& operator+=(CharT ch) {
+        push_back(ch);
+        return *this;
+    }
+
+    constexpr basic_string& operator+=(std::initializer_list<CharT> ilist) {
+        return append(ilist.begin(), ilist.size());
+    }
+
+    constexpr basic_string& insert(size_type index, size_type count, CharT ch) {
+        return replace(index, 0, count, ch);
+    }
+
+    constexpr basic_string& insert(size_type index, const CharT* s, size_type count) {
+        return replace(index, 0, s, count);
+    }
+
+    constexpr basic_string& insert(size_type index, const CharT* s) {
+        return replace(index, 0, s, Traits::length(s));
+    }
+
+    constexpr basic_string& insert(size_type index, view_type view) {
+        return replace(index, 0, view.data(), view.size());
+    }
+
+    constexpr iterator insert(const_iterator pos, CharT ch) {
+        size_type index = static_cast<size_type>(pos - cbegin());
+        replace(index, 0, 1, ch);
+        return begin() + index;
+    }
+
+    constexpr iterator insert(const_iterator pos, size_type count, CharT ch) {
+        size_type index = static_cast<size_type>(pos - cbegin());
+        replace(index, 0, count, ch);
+        return begin() + index;
+    }
+
+    constexpr basic_string& erase(size_type index = 0, size_type count = npos) {
+        size_type sz = size();
+        if (index > sz) {
+            throw std::out_of_range("Index out of range");
+        }
+        count = std::min(count, sz - index);
+        pointer p = data();
+        Traits::move(p + index, p + index + count, sz - index - count);
+        set_size(sz - count);
+        return *this;
+    }
+
+    constexpr iterator erase(const_iterator pos) {
+        size_type index = static_cast<size_type>(pos - cbegin());
+        erase(index, 1);
+        return begin() + index;
+    }
+
+    constexpr iterator erase(const_iterator first, const_iterator last) {
+        size_type index = static_cast<size_type>(first - cbegin());
+        erase(index, static_cast<size_type>(last - first));
+        return begin() + index;
+    }
+
+    // Replaces [pos, pos + count) with s[0, count2); s may point into *this.
+    constexpr basic_string& replace(size_type pos, size_type count,
+                                    const CharT* s, size_type count2) {
+        size_type sz = size();
+        if (pos > sz) {
+            throw std::out_of_range("Index out of range");
+        }
+        count = std::min(count, sz - pos);
+        if (count2 > count && count2 - count > max_size() - sz) {
+            throw std::length_error("Try to allocate space larger than max_size()");
+        }
+        size_type new_sz = sz - count + count2;
+        pointer p = data();
+        if (new_sz <= capacity()) {
+            std::less<> before;
+            if (count2 != 0 && !before(s, p) && before(s, p + sz)) {
+                // the tail shift below would move the source
+                basic_string tmp(s, count2, m_alloc);
+                return replace(pos, count, tmp.data(), count2);
+            }
+            Traits::move(p + pos + count2, p + pos + count, sz - pos - count);
+            Traits::copy(p + pos, s, count2);
+            set_size(new_sz);
+        } else {
+            auto new_buf = allocate_for(next_capacity(new_sz - sz));
+            Traits::copy(new_buf.ptr, p, pos);
+            Traits::copy(new_buf.ptr + pos, s, count2);
+            Traits::copy(new_buf.ptr + pos + count2, p + pos + count, sz - pos - count);
+            replace_with(new_buf, new_sz);
+        }
+        return *this;
+    }
+
+    constexpr basic_string& replace(size_type pos, size_type count, view_type view) {
+        return replace(pos, count, view.data(), view.size());
+    }
+
+    constexpr basic_string& replace(size_type pos, size_type count, size_type count2, CharT ch) {
+        size_type sz = size();
+        if (pos > sz) {
+            throw std::out_of_range("Index out of range");
+        }
+        count = std::min(count, sz - pos);
+        if (count2 > count) {
+            // grows, and fills the new tail, which the move below overwrites
+            append(count2 - count, ch);
+        }
+        pointer p = data();
+        Traits::move(p + pos + count2, p + pos + count, sz - pos - count);
+        Traits::assign(p + pos, count2, ch);
+        if (count2 <= count) {
+            set_size(sz - (count - count2));
+        }
+        return *this;
+    }
+
+    constexpr void resize(size_type count) {
+        resize(count, CharT());
+    }
+
+    constexpr void resize(size_type count, CharT ch) {
+        size_type sz = size();
+        if (count > sz) {
+            append(count - sz, ch);
+        } else {
+            set_size(count);
+        }
+    }
+
+    // Resizes to `count` chars, the new ones left for the caller to
+    // overwrite, then calls op(data(), count) to fill them. op returns the
+    // new size, which must not exceed `count`.
+    template<class Operation>
+    constexpr void resize_and_overwrite(size_type count, Operation op) {
+        if (count > capacity()) {
+            if (count > max_size()) {
+                throw std::length_error("Try to allocate space larger than max_size()");
+            }
+            grow_to(std::max(count, next_capacity(0)));
+        }
+        auto new_sz = static_cast<size_type>(std::move(op)(data(), count));
+        assert(new_sz <= count && "resize_and_overwrite operation overflowed");
+        set_size(new_sz);
+    }
+
+    constexpr void swap(basic_string& other) noexcept {
+        if (this != &other) {
+            if constexpr (alloc_traits::propagate_on_container_swap::value) {
+                using std::swap;
+                swap(m_alloc, other.m_alloc);
+            } else {
+                assert((alloc_traits::is_always_equal::value || m_alloc == other.m_alloc) &&
+                       "Swapped strings with unequal allocators");
+            }
+            std::swap(m_rep, other.m_rep);
+        }
+    }
+
+    // operations
+    constexpr basic_string substr(size_type pos = 0, size_type count = npos) const {
+        size_type sz = size();
+        if (pos > sz) {
+            throw std::out_of_range("Index out of range");
+        }
+        return basic_string(data() + pos, std::min(count, sz - pos), m_alloc);
+    }
+
+    constexpr int compare(view_type view) const noexcept {
+        return view_type(*this).compare(view);
+    }
+
+    constexpr bool starts_with(view_type view) const noexcept {
+        return view_type(*this).starts_with(view);
+    }
+
+    constexpr bool starts_with(CharT ch) const noexcept {
+        return view_type(*this).starts_with(ch);
+    }
+
+    constexpr bool ends_with(view_type view) const noexcept {
+        return view_type(*this).ends_with(view);
+    }
+
+    constexpr bool ends_with(CharT ch) const noexcept {
+        return view_type(*this).ends_with(ch);
+    }
+
+    constexpr bool contains(view_type view) const noexcept {
+        return find(view) != npos;
+    }
+
+    constexpr bool contains(CharT ch) const noexcept {
+        return find(ch) != npos;
+    }
+
+    // search, through the string_view algorithms
+    constexpr size_type find(view_type view, size_type pos = 0) const noexcept {
+        return view_type(*this).find(view, pos);
+    }
+
+    constexpr size_type find(CharT ch, size_type pos = 0) const noexcept {
+        return view_type(*this).find(ch, pos);
+    }
+
+    constexpr size_type rfind(view_type view, size_type pos = npos) const noexcept {
+        return view_type(*this).rfind(view, pos);
+    }
+
+    constexpr size_type rfind(CharT ch, size_type pos = npos) const noexcept {
+        return view_type(*this).rfind(ch, pos);
+    }
+
+    constexpr size_type find_first_of(view_type view, size_type pos = 0) const noexcept {
+        return view_type(*this).find_first_of(view, pos);
+    }
+
+    constexpr size_type find_first_of(CharT ch, size_type pos = 0) const noexcept {
+        return view_type(*this).find_first_of(ch, pos);
+    }
+
+    constexpr size_type find_first_not_of(view_type view, size_type pos = 0) const noexcept {
+        return view_type(*this).find_first_not_of(view, pos);
+    }
+
+    constexpr size_type find_first_not_of(CharT ch, size_type pos = 0) const noexcept {
+        return view_type(*this).find_first_not_of(ch, pos);
+    }
+
+    constexpr size_type find_last_of(view_type view, size_type pos = npos) const noexcept {
+        return view_type(*this).find_last_of(view, pos);
+    }
+
+    constexpr size_type find_last_of(CharT ch, size_type pos = npos) const noexcept {
+        return view_type(*this).find_last_of(ch, pos);
+    }
+
+    constexpr size_type find_last_not_of(view_type view, size_type pos = npos) const noexcept {
+        return view_type(*this).find_last_not_of(view, pos);
+    }
+
+    constexpr size_type find_last_not_of(CharT ch, size_type pos = npos) const noexcept {
+        return view_type(*this).find_last_not_of(ch, pos);
+    }
+
+private:
+    constexpr bool is_long() const noexcept {
+        if consteval {
+            return true;
+        }
+        return (reinterpret_cast<const unsigned char*>(&m_rep)[sizeof(rep) - 1] & long_flag) != 0;
+    }
+
+    static constexpr size_type encode_capacity(size_type cap) noexcept {
+        return (cap << cap_shift) | (size_type{long_flag} << flag_shift);
+    }
+
+    static constexpr size_type decode_capacity(size_type encoded) noexcept {
+        return (encoded & ~(size_type{long_flag} << flag_shift)) >> cap_shift;
+    }
+
+    // Constant evaluation keeps every string on the heap, since it cannot
+    // read the last byte through the union member that is not active.
+    static constexpr bool fits_inline(size_type count) noexcept {
+        if consteval {
+            return false;
+        }
+        return count <= inline_capacity;
+    }
+
+    // empty, whatever the object held before
+    constexpr void set_empty() noexcept {
+        if consteval {
+            auto new_buf = allocate_for(0);
+            m_rep.l = long_rep{new_buf.ptr, 0, encode_capacity(new_buf.count - 1)};
+            new_buf.ptr[0] = CharT();
+        } else {
+            m_rep.s = short_rep{};
+        }
+    }
+
+    constexpr void set_short_size(size_type sz) noexcept {
+        m_rep.s.tail[tail_size - 1] = static_cast<unsigned char>(sz);
+        m_rep.s.data[sz] = CharT();
+    }
+
+    constexpr void set_size(size_type sz) noexcept {
+        if (is_long()) {
+            m_rep.l.size = sz;
+            m_rep.l.data[sz] = CharT();
+        } else {
+            set_short_size(sz);
+        }
+    }
+
+    // A buffer for at least `cap` chars and the null char.
+    constexpr allocation_result<pointer, size_type> allocate_for(size_type cap) {
+        if (cap > max_size()) {
+            throw std::length_error("Try to allocate space larger than max_size()");
+        }
+        return my::allocate_at_least(m_alloc, cap + 1);
+    }
+
+    // Storage for `count` chars in a fresh object; the caller fills them.
+    constexpr pointer init(size_type count) {
+        if (fits_inline(count)) {
+            set_empty();
+            set_short_size(count);
+            return m_rep.s.data;
+        }
+        auto new_buf = allocate_for(count);
+        m_rep.l = long_rep{new_buf.ptr, count, encode_capacity(new_buf.count - 1)};
+        new_buf.ptr[count] = CharT();
+        return new_buf.ptr;
+    }
+
+    constexpr void release() noexcept {
+        if (is_long()) {
+            m_alloc.deallocate(m_rep.l.data, decode_capacity(m_rep.l.cap) + 1);
+        }
+    }
+
+    // Frees the old buffer and adopts new_buf, whose first sz chars are set.
+    constexpr void replace_with(allocation_result<pointer, size_type> new_buf, size_type sz) {
+        release();
+        m_rep.l = long_rep{new_buf.ptr, sz, encode_capacity(new_buf.count - 1)};
+        new_buf.ptr[sz] = CharT();
+    }
+
+    constexpr void take_storage(basic_string& other) noexcept {
+        release();
+        m_rep = other.m_rep;
+        other.set_empty();
+    }
+
+    constexpr size_type next_capacity(size_type count) const {
+        size_type sz = size();
+        if (count > max_size() - sz) {
+            throw std::length_error("Try to allocate space larger than max_size()");
+        }
+        size_type required = sz + count;
+        size_type cap = capacity();
+        return std::max(required, cap > max_size() / 2 ? max_size() : 2 * cap);
+    }
+
+    // Out of line, so that the fast paths of append stay small.
+    [[gnu::noinline]] constexpr basic_string& append_to_new_buffer(const CharT* s, size_type count) {
+        size_type sz = size();
+        // copy before the old buffer goes away
+        auto new_buf = allocate_for(next_capacity(count));
+        Traits::copy(new_buf.ptr, data(), sz);
+        Traits::copy(new_buf.ptr + sz, s, count);
+        replace_with(new_buf, sz + count);
+        return *this;
+    }
+
+    constexpr void grow_to(size_type new_cap) {
+        auto new_buf = allocate_for(new_cap);
+        size_type sz = size();
+        Traits::copy(new_buf.ptr, data(), sz);
+        replace_with(new_buf, sz);
+    }
+}; // class basic_string
+
+// Inline contents hold no pointer into the object, so the bytes can move
+// along with a stateless or relocatable allocator.
+template<class CharT, class Traits, class Alloc>
+struct is_trivially_relocatable<basic_string<CharT, Traits, Alloc>>
+    : std::bool_constant<std::is_empty_v<Alloc> || is_trivially_relocatable_v<Alloc>> {};
+
+template<class CharT, class Traits, class Alloc>
+constexpr void swap(basic_string<CharT, Traits, Alloc>& lhs,
+                    basic_string<CharT, Traits, Alloc>& rhs) noexcept {
+    lhs.swap(rhs);
+}
+
+template<class CharT, class Traits, class Alloc>
+constexpr bool operator==(const basic_string<CharT, Traits, Alloc>& lhs,
+                          std::type_identity_t<basic_string_view<CharT, Traits>> rhs) noexcept {
+    return basic_string_view<CharT, Traits>(lhs) == rhs;
+}
+
+template<class CharT, class Traits, class Alloc>
+constexpr auto operator<=>(const basic_string<CharT, Traits, Alloc>& lhs,
+                           std::type_identity_t<basic_string_view<CharT, Traits>> rhs) noexcept {
+    return basic_string_view<CharT, Traits>(lhs) <=> rhs;
+}
+
+// operator+ reserves once for both sides
+template<class CharT, class Traits, class Alloc>
+constexpr basic_string<CharT, Traits, Alloc>
+    operator+(const basic_string<CharT, Traits, Alloc>& lhs,
+              std::type_identity_t<basic_string_view<CharT, Traits>> rhs)
+{
+    basic_string<CharT, Traits, Alloc> result(
+        std::allocator_traits<Alloc>::select_on_container_copy_construction(lhs.get_allocator()));
+    result.reserve(lhs.size() + rhs.size());
+    result.append(lhs.data(), lhs.size());
+    result.append(rhs.data(), rhs.size());
+    return result;
+}
+
+template<class CharT, class Traits, class Alloc>
+constexpr basic_string<CharT, Traits, Alloc>
+    operator+(std::type_identity_t<basic_string_view<CharT, Traits>> lhs,
+              const basic_string<CharT, Traits, Alloc>& rhs)
+{
+    basic_string<CharT, Traits, Alloc> result(
+        std::allocator_traits<Alloc>::select_on_container_copy_construction(rhs.get_allocator()));
+    result.reserve(lhs.size() + rhs.size());
+    result.append(lhs.data(), lhs.size());
+    result.append(rhs.data(), rhs.size());
+    return result;
+}
+
+template<class CharT, class Traits, class Alloc>
+constexpr basic_string<CharT, Traits, Alloc>
+    operator+(const basic_string<CharT, Traits, Alloc>& lhs,
+              const basic_string<CharT, Traits, Alloc>& rhs)
+{
+    return lhs + basic_string_view<CharT, Traits>(rhs);
+}
+
+template<class CharT, class Traits, class Alloc>
+constexpr basic_string<CharT, Traits, Alloc>
+    operator+(basic_string<CharT, Traits, Alloc>&& lhs,
+              std::type_identity_t<basic_string_view<CharT, Traits>> rhs)
+{
+    lhs.append(rhs.data(), rhs.size());
+    return std::move(lhs);
+}
+
+template<class CharT, class Traits, class Alloc>
+constexpr basic_string<CharT, Traits, Alloc>
+    operator+(basic_string<CharT, Traits, Alloc>&& lhs,
+              const basic_string<CharT, Traits, Alloc>& rhs)
+{
+    lhs.append(rhs.data(), rhs.size());
+    return std::move(lhs);
+}
+
+template<class CharT, class Traits, class Alloc>
+constexpr basic_string<CharT, Traits, Alloc>
+    operator+(const basic_string<CharT, Traits, Alloc>& lhs, CharT rhs)
+{
+    return lhs + basic_string_view<CharT, Traits>(&rhs, 1);
+}
+
+template<class CharT, class Traits, class Alloc>
+constexpr basic_string<CharT, Traits, Alloc>
+    operator+(basic_string<CharT, Traits, Alloc>&& lhs, CharT rhs)
+{
+    lhs.push_back(rhs);
+    return std::move(lhs);
+}
+
+template<class CharT, class Traits, class Alloc>
+std::basic_ostream<CharT, Traits>&
+    operator<<(std::basic_ostream<CharT, Traits>& os,
+               const basic_string<CharT, Traits, Alloc>& str)
+{
+    return os << basic_string_view<CharT, Traits>(str);
+}
+
+using string = basic_string<char>;
+} // namespace my
+
+namespace std {
+
+// equal to the hash of the string's view
+template<class CharT, class Traits, class Alloc>
+struct hash<my::basic_string<CharT, Traits, Alloc>> {
+    constexpr size_t operator()(const my::basic_string<CharT, Traits, Alloc>& str) const noexcept {
+        return hash<my::basic_string_view<CharT, Traits>>{}(str);
+    }
+};
+
+template<class CharT, class Traits, class Alloc>
+struct formatter<my::basic_string<CharT, Traits, Alloc>, CharT>
+    : formatter<basic_string_view<CharT>, CharT> {
+    auto format(const my::basic_string<CharT, Traits, Alloc>& str, auto& ctx) const {
+        return formatter<basic_string_view<CharT>, CharT>::format(
+            basic_string_view<CharT>(str.data(), str.size()), ctx);
+    }
+};
+
+} // namespace std
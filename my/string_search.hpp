@@ -0,0 +1,616 @@
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+// Search kernels over raw char buffers, shared by the string types. Each
+// public entry point picks the widest kernel the CPU supports on first use.
+
+namespace my {
+
+// Set of byte values, as a 256-bit membership table. Also builds the nibble
+// tables of a shuffle classifier: every byte value gets a low-nibble and a
+// high-nibble row, and a byte is in the set when the two rows share a bit.
+// That is exact as long as the set spans at most 8 distinct high-nibble rows.
+class byte_set {
+    std::uint64_t m_bits[4]{};
+    alignas(16) unsigned char m_low[16]{};
+    alignas(16) unsigned char m_high[16]{};
+    bool m_classifier = false;
+
+public:
+    constexpr byte_set() noexcept { build_classifier(); }
+
+    constexpr byte_set(const char* s, std::size_t count) noexcept {
+        for (std::size_t i = 0; i < count; ++i) {
+            auto c = static_cast<unsigned char>(s[i]);
+            m_bits[c >> 6] |= std::uint64_t{1} << (c & 63);
+        }
+        build_classifier();
+    }
+
+    constexpr bool contains(char ch) const noexcept {
+        auto c = static_cast<unsigned char>(ch);
+        return (m_bits[c >> 6] >> (c & 63)) & 1;
+    }
+
+    constexpr std::size_t size() const noexcept {
+        return static_cast<std::size_t>(std::popcount(m_bits[0]) + std::popcount(m_bits[1]) +
+                                        std::popcount(m_bits[2]) + std::popcount(m_bits[3]));
+    }
+
+    // True when low_table() and high_table() classify every byte exactly.
+    constexpr bool has_classifier() const noexcept {
+        return m_classifier;
+    }
+
+    const unsigned char* low_table() const noexcept {
+        return m_low;
+    }
+
+    const unsigned char* high_table() const noexcept {
+        return m_high;
+    }
+
+private:
+    // High nibbles whose rows of low nibbles are equal share a bit.
+    constexpr void build_classifier() noexcept {
+        std::uint16_t rows[8]{};
+        int used = 0;
+        for (unsigned high = 0; high < 16; ++high) {
+            auto row = static_cast<std::uint16_t>(m_bits[high >> 2] >> ((high & 3) * 16));
+            if (row == 0) {
+                continue;
+            }
+            int k = 0;
+            while (k < used && rows[k] != row) {
+                ++k;
+            }
+            if (k == used) {
+                if (used == 8) {
+                    return;
+                }
+                rows[used++] = row;
+            }
+            m_high[high] |= static_cast<unsigned char>(1u << k);
+            for (unsigned low = 0; low < 16; ++low) {
+                if ((row >> low) & 1) {
+                    m_low[low] |= static_cast<unsigned char>(1u << k);
+                }
+            }
+        }
+        m_classifier = true;
+    }
+}; // class byte_set
+
+namespace {
+
+// The substring kernels charge m bytes of `budget` for every candidate that
+// fails verification. Once the budget cannot cover another candidate they
+// stop, set it to zero and return that candidate unverified, so the caller
+// can finish the search with an algorithm of linear worst case.
+
+// memchr for the first char, memcmp for the rest
+inline const char* find_substring_scalar(const char* hay, std::size_t n, const char* needle,
+                                         std::size_t m, std::size_t& budget) noexcept {
+    const char* const last = hay + n;
+    while (static_cast<std::size_t>(last - hay) >= m) {
+        hay = static_cast<const char*>(
+            std::memchr(hay, needle[0], static_cast<std::size_t>(last - hay) - m + 1));
+        if (hay == nullptr) {
+            return nullptr;
+        }
+        if (budget < m) {
+            budget = 0;
+            return hay;
+        }
+        if (std::memcmp(hay + 1, needle + 1, m - 1) == 0) {
+            return hay;
+        }
+        budget -= m;
+        ++hay;
+    }
+    return nullptr;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+// Compares a block of candidate positions at once against the first and the
+// last needle char, and only runs memcmp where both match. A common first
+// char alone no longer triggers a compare at every occurrence. The last
+// block is aligned to the end of the haystack instead of leaving a scalar
+// tail, with the positions already checked masked out, which is what keeps
+// short haystacks fast.
+__attribute__((target("sse2")))
+inline const char* find_substring_sse2(const char* hay, std::size_t n, const char* needle,
+                                       std::size_t m, std::size_t& budget) noexcept {
+    const std::size_t windows = n - m + 1;
+    if (windows < 16) {
+        return find_substring_scalar(hay, n, needle, m, budget);
+    }
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last = _mm_set1_epi8(needle[m - 1]);
+    for (std::size_t i = 0; i < windows; i += 16) {
+        std::size_t at = i;
+        unsigned keep = 0xFFFFu;
+        if (i + 16 > windows) {
+            at = windows - 16;
+            keep <<= i - at;
+        }
+        __m128i block_first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hay + at));
+        __m128i block_last = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hay + at + m - 1));
+        auto mask = static_cast<unsigned>(_mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(block_first, first), _mm_cmpeq_epi8(block_last, last)))) & keep;
+        while (mask != 0) {
+            unsigned bit = static_cast<unsigned>(std::countr_zero(mask));
+            if (budget < m) {
+                budget = 0;
+                return hay + at + bit;
+            }
+            if (std::memcmp(hay + at + bit + 1, needle + 1, m - 2) == 0) {
+                return hay + at + bit;
+            }
+            budget -= m;
+            mask &= mask - 1;
+        }
+    }
+    return nullptr;
+}
+
+__attribute__((target("avx2")))
+inline const char* find_substring_avx2(const char* hay, std::size_t n, const char* needle,
+                                       std::size_t m, std::size_t& budget) noexcept {
+    const std::size_t windows = n - m + 1;
+    if (windows < 32) {
+        return find_substring_sse2(hay, n, needle, m, budget);
+    }
+    const __m256i first = _mm256_set1_epi8(needle[0]);
+    const __m256i last = _mm256_set1_epi8(needle[m - 1]);
+    for (std::size_t i = 0; i < windows; i += 32) {
+        std::size_t at = i;
+        unsigned keep = ~0u;
+        if (i + 32 > windows) {
+            at = windows - 32;
+            keep <<= i - at;
+        }
+        __m256i block_first = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(hay + at));
+        __m256i block_last = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(hay + at + m - 1));
+        auto mask = static_cast<unsigned>(_mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi8(block_first, first), _mm256_cmpeq_epi8(block_last, last)))) & keep;
+        while (mask != 0) {
+            unsigned bit = static_cast<unsigned>(std::countr_zero(mask));
+            if (budget < m) {
+                budget = 0;
+                return hay + at + bit;
+            }
+            if (std::memcmp(hay + at + bit + 1, needle + 1, m - 2) == 0) {
+                return hay + at + bit;
+            }
+            budget -= m;
+            mask &= mask - 1;
+        }
+    }
+    return nullptr;
+}
+#endif
+
+using substring_kernel = const char* (*)(const char*, std::size_t, const char*, std::size_t,
+                                         std::size_t&) noexcept;
+
+inline substring_kernel select_substring_kernel() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+    if (__builtin_cpu_supports("avx2")) {
+        return find_substring_avx2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return find_substring_sse2;
+    }
+#endif
+    return find_substring_scalar;
+}
+
+// The widest substring kernel of this CPU, picked on first use.
+inline substring_kernel best_substring_kernel() noexcept {
+    static const substring_kernel kernel = select_substring_kernel();
+    return kernel;
+}
+
+// The set kernels return the first (or last) char whose membership in the
+// set equals `member`, so one kernel serves both find_*_of and find_*_not_of.
+inline const char* find_in_set_scalar(const char* hay, std::size_t n,
+                                      const byte_set& set, bool member) noexcept {
+    for (std::size_t i = 0; i < n; ++i) {
+        if (set.contains(hay[i]) == member) {
+            return hay + i;
+        }
+    }
+    return nullptr;
+}
+
+inline const char* rfind_in_set_scalar(const char* hay, std::size_t n,
+                                       const byte_set& set, bool member) noexcept {
+    while (n-- > 0) {
+        if (set.contains(hay[n]) == member) {
+            return hay + n;
+        }
+    }
+    return nullptr;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+// Two pshufb lookups per block, one by the low and one by the high nibble;
+// a zero AND of the two marks the bytes outside the set.
+__attribute__((target("ssse3")))
+inline unsigned outside_set_ssse3(__m128i block, __m128i low_table, __m128i high_table) noexcept {
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    __m128i low = _mm_shuffle_epi8(low_table, _mm_and_si128(block, nibble));
+    __m128i high = _mm_shuffle_epi8(high_table, _mm_and_si128(_mm_srli_epi16(block, 4), nibble));
+    return static_cast<unsigned>(_mm_movemask_epi8(
+        _mm_cmpeq_epi8(_mm_and_si128(low, high), _mm_setzero_si128())));
+}
+
+__attribute__((target("ssse3")))
+inline const char* find_in_set_ssse3(const char* hay, std::size_t n,
+                                     const byte_set& set, bool member) noexcept {
+    if (!set.has_classifier()) {
+        return find_in_set_scalar(hay, n, set, member);
+    }
+    const __m128i low_table = _mm_load_si128(reinterpret_cast<const __m128i*>(set.low_table()));
+    const __m128i high_table = _mm_load_si128(reinterpret_cast<const __m128i*>(set.high_table()));
+    const unsigned flip = member ? 0xFFFFu : 0u;
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hay + i));
+        unsigned mask = outside_set_ssse3(block, low_table, high_table) ^ flip;
+        if (mask != 0) {
+            return hay + i + std::countr_zero(mask);
+        }
+    }
+    return find_in_set_scalar(hay + i, n - i, set, member);
+}
+
+__attribute__((target("ssse3")))
+inline const char* rfind_in_set_ssse3(const char* hay, std::size_t n,
+                                      const byte_set& set, bool member) noexcept {
+    if (!set.has_classifier()) {
+        return rfind_in_set_scalar(hay, n, set, member);
+    }
+    const __m128i low_table = _mm_load_si128(reinterpret_cast<const __m128i*>(set.low_table()));
+    const __m128i high_table = _mm_load_si128(reinterpret_cast<const __m128i*>(set.high_table()));
+    const unsigned flip = member ? 0xFFFFu : 0u;
+    for (; n >= 16; n -= 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hay + n - 16));
+        unsigned mask = outside_set_ssse3(block, low_table, high_table) ^ flip;
+        if (mask != 0) {
+            return hay + n - 16 + (std::bit_width(mask) - 1);
+        }
+    }
+    return rfind_in_set_scalar(hay, n, set, member);
+}
+
+__attribute__((target("avx2")))
+inline unsigned outside_set_avx2(__m256i block, __m256i low_table, __m256i high_table) noexcept {
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    __m256i low = _mm256_shuffle_epi8(low_table, _mm256_and_si256(block, nibble));
+    __m256i high = _mm256_shuffle_epi8(high_table,
+                                       _mm256_and_si256(_mm256_srli_epi16(block, 4), nibble));
+    return static_cast<unsigned>(_mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(_mm256_and_si256(low, high), _mm256_setzero_si256())));
+}
+
+__attribute__((target("avx2")))
+inline const char* find_in_set_avx2(const char* hay, std::size_t n,
+                                    const byte_set& set, bool member) noexcept {
+    if (!set.has_classifier()) {
+        return find_in_set_scalar(hay, n, set, member);
+    }
+    const __m256i low_table = _mm256_broadcastsi128_si256(
+        _mm_load_si128(reinterpret_cast<const __m128i*>(set.low_table())));
+    const __m256i high_table = _mm256_broadcastsi128_si256(
+        _mm_load_si128(reinterpret_cast<const __m128i*>(set.high_table())));
+    const unsigned flip = member ? ~0u : 0u;
+    std::size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(hay + i));
+        unsigned mask = outside_set_avx2(block, low_table, high_table) ^ flip;
+        if (mask != 0) {
+            return hay + i + std::countr_zero(mask);
+        }
+    }
+    return find_in_set_ssse3(hay + i, n - i, set, member);
+}
+
+__attribute__((target("avx2")))
+inline const char* rfind_in_set_avx2(const char* hay, std::size_t n,
+                                     const byte_set& set, bool member) noexcept {
+    if (!set.has_classifier()) {
+        return rfind_in_set_scalar(hay, n, set, member);
+    }
+    const __m256i low_table = _mm256_broadcastsi128_si256(
+        _mm_load_si128(reinterpret_cast<const __m128i*>(set.low_table())));
+    const __m256i high_table = _mm256_broadcastsi128_si256(
+        _mm_load_si128(reinterpret_cast<const __m128i*>(set.high_table())));
+    const unsigned flip = member ? ~0u : 0u;
+    for (; n >= 32; n -= 32) {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(hay + n - 32));
+        unsigned mask = outside_set_avx2(block, low_table, high_table) ^ flip;
+        if (mask != 0) {
+            return hay + n - 32 + (std::bit_width(mask) - 1);
+        }
+    }
+    return rfind_in_set_ssse3(hay, n, set, member);
+}
+#endif
+
+using set_kernel = const char* (*)(const char*, std::size_t, const byte_set&, bool) noexcept;
+
+struct set_kernels {
+    set_kernel forward;
+    set_kernel backward;
+};
+
+inline set_kernels select_set_kernels() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+    if (__builtin_cpu_supports("avx2")) {
+        return { find_in_set_avx2, rfind_in_set_avx2 };
+    }
+    if (__builtin_cpu_supports("ssse3")) {
+        return { find_in_set_ssse3, rfind_in_set_ssse3 };
+    }
+#endif
+    return { find_in_set_scalar, rfind_in_set_scalar };
+}
+
+} // anonymous namespace
+
+// Two-Way string matching (Crochemore-Perrin) with a Horspool shift on the
+// last window byte, as in glibc's long-needle strstr. The needle is split at
+// a critical factorization: the right half is matched left to right, then
+// the left half right to left, and a mismatch shifts by the period or past
+// the mismatch. That bounds the search to O(n + m) comparisons with O(1)
+// extra state besides the byte shift table, which lets typical text skip up
+// to m bytes per window.
+//
+// With Reverse set, needle and haystack are read back to front, so find()
+// returns the last occurrence instead of the first.
+//
+// Holds a pointer to the needle, which must outlive the matcher.
+template<bool Reverse = false>
+class two_way_matcher {
+    const char* m_needle;
+    std::size_t m_size;
+    std::size_t m_split;
+    std::size_t m_period;
+    bool m_periodic;
+    std::size_t m_shift[256];
+
+public:
+    two_way_matcher(const char* needle, std::size_t m) noexcept :
+        m_needle{needle}, m_size{m}
+    {
+        std::size_t period = 1;
+        m_split = critical_factorization(period);
+        m_periodic = true;
+        for (std::size_t i = 0; i < m_split; ++i) {
+            if (at(i) != at(i + period)) {
+                m_periodic = false;
+                break;
+            }
+        }
+        // without a period on the left half, any mismatch past the split
+        // rules out every shift below the longer half
+        m_period = m_periodic ? period : std::max(m_split, m - m_split) + 1;
+
+        for (std::size_t& shift : m_shift) {
+            shift = m;
+        }
+        for (std::size_t i = 0; i < m; ++i) {
+            m_shift[at(i)] = m - i - 1;
+        }
+    }
+
+    std::size_t size() const noexcept {
+        return m_size;
+    }
+
+    // First occurrence in hay[0, n), or the last one when Reverse; null if
+    // there is none. The needle must not be empty.
+    const char* find(const char* hay, std::size_t n) const noexcept {
+        const std::size_t m = m_size;
+        if (m > n) {
+            return nullptr;
+        }
+        auto hay_at = [&](std::size_t i) -> unsigned char {
+            if constexpr (Reverse) {
+                return static_cast<unsigned char>(hay[n - 1 - i]);
+            } else {
+                return static_cast<unsigned char>(hay[i]);
+            }
+        };
+        auto found = [&](std::size_t j) {
+            return Reverse ? hay + (n - j - m) : hay + j;
+        };
+
+        // bytes of the right half known to match from the previous window
+        std::size_t memory = 0;
+        std::size_t j = 0;
+        while (j <= n - m) {
+            std::size_t shift = m_shift[hay_at(j + m - 1)];
+            if (shift != 0) {
+                // a periodic needle with its last period broken cannot
+                // match until the window is past the break
+                if (memory != 0 && shift < m_period) {
+                    shift = m - m_period;
+                }
+                memory = 0;
+                j += shift;
+                continue;
+            }
+            std::size_t i = std::max(m_split, memory);
+            while (i < m - 1 && at(i) == hay_at(i + j)) {
+                ++i;
+            }
+            if (i < m - 1) {
+                j += i - m_split + 1;
+                memory = 0;
+                continue;
+            }
+            i = m_split;
+            while (i > memory && at(i - 1) == hay_at(i - 1 + j)) {
+                --i;
+            }
+            if (i <= memory) {
+                return found(j);
+            }
+            j += m_period;
+            memory = m_periodic ? m - m_period : 0;
+        }
+        return nullptr;
+    }
+
+private:
+    unsigned char at(std::size_t i) const noexcept {
+        if constexpr (Reverse) {
+            return static_cast<unsigned char>(m_needle[m_size - 1 - i]);
+        } else {
+            return static_cast<unsigned char>(m_needle[i]);
+        }
+    }
+
+    // Split point of the needle: the later of its maximal suffixes under
+    // the byte order and under the reversed order. Sets the period of that
+    // suffix.
+    std::size_t critical_factorization(std::size_t& period) const noexcept {
+        if (m_size < 3) {
+            period = 1;
+            return m_size == 0 ? 0 : m_size - 1;
+        }
+        std::size_t forward_period = 1;
+        std::size_t forward = maximal_suffix(false, forward_period);
+        std::size_t backward_period = 1;
+        std::size_t backward = maximal_suffix(true, backward_period);
+        if (backward + 1 < forward + 1) {
+            period = forward_period;
+            return forward + 1;
+        }
+        period = backward_period;
+        return backward + 1;
+    }
+
+    // Start of the maximal suffix, minus one (wrapping to SIZE_MAX for the
+    // whole needle), and the period of that suffix.
+    std::size_t maximal_suffix(bool reversed_order, std::size_t& period) const noexcept {
+        std::size_t suffix = static_cast<std::size_t>(-1);
+        std::size_t j = 0;
+        std::size_t k = 1;
+        period = 1;
+        while (j + k < m_size) {
+            unsigned char a = at(j + k);
+            unsigned char b = at(suffix + k);
+            if (a == b) {
+                if (k != period) {
+                    ++k;
+                } else {
+                    j += period;
+                    k = 1;
+                }
+            } else if ((a < b) != reversed_order) {
+                j += k;
+                k = 1;
+                period = j - suffix;
+            } else {
+                suffix = j++;
+                k = 1;
+                period = 1;
+            }
+        }
+        return suffix;
+    }
+}; // class two_way_matcher
+
+// Needles from this length on get a verification budget linear in the
+// haystack, and go to two_way_matcher once it runs out. Shorter needles
+// cost at most this many bytes per candidate anyway.
+inline constexpr std::size_t two_way_threshold = 32;
+
+// Runs kernel over hay[0, n) for a needle with 2 <= m <= n. Needles of
+// two_way_threshold bytes or more get a budget linear in n; when it runs
+// out, finish(from, count) completes the search over hay[from, from + count)
+// with a two_way_matcher.
+template<class Finish>
+inline const char* find_substring_with(substring_kernel kernel, const char* hay, std::size_t n,
+                                       const char* needle, std::size_t m, Finish&& finish) noexcept {
+    std::size_t budget = (m >= two_way_threshold) ? 2 * n + 4096 : static_cast<std::size_t>(-1);
+    const char* result = kernel(hay, n, needle, m, budget);
+    if (result != nullptr && budget == 0) {
+        return finish(result, n - static_cast<std::size_t>(result - hay));
+    }
+    return result;
+}
+
+// First occurrence of needle[0, m) in hay[0, n), or null.
+inline const char* find_substring(const char* hay, std::size_t n,
+                                  const char* needle, std::size_t m) noexcept {
+    if (m == 0) {
+        return hay;
+    }
+    if (m > n) {
+        return nullptr;
+    }
+    if (m == 1) {
+        return static_cast<const char*>(std::memchr(hay, needle[0], n));
+    }
+    return find_substring_with(best_substring_kernel(), hay, n, needle, m,
+                               [&](const char* from, std::size_t count) {
+                                   return two_way_matcher<>{needle, m}.find(from, count);
+                               });
+}
+
+// Last occurrence of needle[0, m) in hay[0, n), or null. An empty needle
+// matches at hay + n.
+inline const char* rfind_substring(const char* hay, std::size_t n,
+                                   const char* needle, std::size_t m) noexcept {
+    if (m == 0) {
+        return hay + n;
+    }
+    if (m > n) {
+        return nullptr;
+    }
+    // the scalar mirror of the forward kernels, with the same budget
+    std::size_t budget = (m >= two_way_threshold) ? 2 * n + 4096 : static_cast<std::size_t>(-1);
+    for (std::size_t j = n - m + 1; j-- > 0;) {
+        if (hay[j] != needle[0] || hay[j + m - 1] != needle[m - 1]) {
+            continue;
+        }
+        if (budget < m) {
+            return two_way_matcher<true>{needle, m}.find(hay, j + m);
+        }
+        if (std::memcmp(hay + j + 1, needle + 1, m - 1) == 0) {
+            return hay + j;
+        }
+        budget -= m;
+    }
+    return nullptr;
+}
+
+// First char of hay[0, n) that is in the set when `member` is true, or that
+// is not in it otherwise; null if there is none.
+inline const char* find_in_set(const char* hay, std::size_t n,
+                               const byte_set& set, bool member) noexcept {
+    static const set_kernels kernels = select_set_kernels();
+    return kernels.forward(hay, n, set, member);
+}
+
+// Same as find_in_set, scanning from the end.
+inline const char* rfind_in_set(const char* hay, std::size_t n,
+                                const byte_set& set, bool member) noexcept {
+    static const set_kernels kernels = select_set_kernels();
+    return kernels.backward(hay, n, set, member);
+}
+
+} // namespace my
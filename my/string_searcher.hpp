@@ -0,0 +1,115 @@
+#pragma once
+#include <concepts>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include "string_search.hpp"
+#include "string_view.hpp"
+#include "vector.hpp"
+
+namespace my {
+
+// A needle prepared once for many searches. Construction copies the needle,
+// computes its Two-Way factorization and byte shift table, and picks the
+// substring kernel of this CPU; find() then goes straight to the kernel.
+// Char types other than plain char fall back to basic_string_view::find.
+template<class CharT, class Traits>
+class basic_string_searcher {
+public:
+    using view_type = basic_string_view<CharT, Traits>;
+    using size_type = std::size_t;
+
+    static constexpr size_type npos = view_type::npos;
+
+private:
+    static constexpr bool byte_search =
+        std::same_as<CharT, char> && std::same_as<Traits, std::char_traits<char>>;
+
+    struct no_matcher {
+        no_matcher(const CharT*, size_type) noexcept {}
+    };
+    using matcher_type = std::conditional_t<byte_search, two_way_matcher<>, no_matcher>;
+    using kernel_type = std::conditional_t<byte_search, substring_kernel, std::nullptr_t>;
+
+    vector<CharT> m_needle;
+    // points into m_needle, so copies rebuild it
+    matcher_type m_matcher;
+    kernel_type m_kernel;
+
+public:
+    // constructors
+    explicit basic_string_searcher(view_type needle) :
+        m_needle(needle.begin(), needle.end()),
+        m_matcher{m_needle.data(), m_needle.size()},
+        m_kernel{}
+    {
+        if constexpr (byte_search) {
+            m_kernel = best_substring_kernel();
+        }
+    }
+
+    basic_string_searcher(const basic_string_searcher& other) :
+        basic_string_searcher(other.needle()) {}
+
+    // moving keeps the needle buffer, and with it the matcher
+    basic_string_searcher(basic_string_searcher&& other) noexcept = default;
+
+    basic_string_searcher& operator=(const basic_string_searcher& other) {
+        if (this != &other) {
+            *this = basic_string_searcher(other);
+        }
+        return *this;
+    }
+
+    basic_string_searcher& operator=(basic_string_searcher&& other) noexcept = default;
+
+    view_type needle() const noexcept {
+        return view_type(m_needle.data(), m_needle.size());
+    }
+
+    // Offset of the first occurrence in hay at or after pos, or npos.
+    size_type find(view_type hay, size_type pos = 0) const noexcept {
+        if (pos > hay.size()) {
+            return npos;
+        }
+        if constexpr (byte_search) {
+            const char* result = search(hay.data() + pos, hay.size() - pos);
+            return result ? static_cast<size_type>(result - hay.data()) : npos;
+        } else {
+            return hay.find(needle(), pos);
+        }
+    }
+
+    // Offsets of every occurrence in hay, overlapping ones included.
+    vector<size_type> find_all(view_type hay) const {
+        vector<size_type> offsets;
+        for (size_type pos = find(hay); pos != npos; pos = find(hay, pos + 1)) {
+            offsets.push_back(pos);
+        }
+        return offsets;
+    }
+
+private:
+    const char* search(const char* hay, size_type n) const noexcept {
+        const size_type m = m_needle.size();
+        if (m == 0) {
+            return hay;
+        }
+        if (m > n) {
+            return nullptr;
+        }
+        if (m == 1) {
+            return static_cast<const char*>(std::memchr(hay, m_needle[0], n));
+        }
+        return find_substring_with(m_kernel, hay, n, m_needle.data(), m,
+                                   [&](const char* from, size_type count) {
+                                       return m_matcher.find(from, count);
+                                   });
+    }
+}; // class basic_string_searcher
+
+using string_searcher = basic_string_searcher<char, std::char_traits<char>>;
+
+} // namespace my
@@ -4,17 +4,23 @@
 #include <cstddef>
 #include <cstring>
 #include <format>
+#include <functional>
 #include <memory>
 #include <stdexcept>
 #include <type_traits>
 #include <iterator>
 #include <iostream>
 #include <ranges>
+#include "hash.hpp"
+#include "string_search.hpp"
 
 namespace stdv = std::ranges::views;
 
 namespace my {
 
+template<class CharT, class Traits = std::char_traits<CharT>>
+class basic_string_searcher;
+
 template< class CharT, class Traits = std::char_traits<CharT>>
     requires (!std::is_array_v<CharT>) &&
              (std::is_trivially_copyable_v<CharT>) &&
@@ -41,6 +47,10 @@ public:
 private:
     const CharT* m_data;
     std::size_t  m_size;
+
+    // Plain chars go through the byte kernels of string_search.hpp at runtime.
+    static constexpr bool byte_search =
+        std::same_as<CharT, char> && std::same_as<Traits, std::char_traits<char>>;
 public:
     constexpr basic_string_view() noexcept
     : m_data{nullptr}, m_size{0} {}
@@ -284,6 +294,13 @@ public:
         if (count == 0) return pos <= m_size ? pos : npos;
         if (pos >= m_size || count > m_size - pos) return npos;
 
+        if constexpr (byte_search) {
+            if !consteval {
+                const char* result = find_substring(m_data + pos, m_size - pos, s, count);
+                return result ? result - m_data : npos;
+            }
+        }
+
         const CharT elem0 = s[0];
         const CharT* first = m_data + pos;
         const CharT* const last = m_data + m_size;
@@ -305,6 +322,11 @@ public:
         return find(s, pos, Traits::length(s));
     }
 
+    // Searches with a prepared needle; needs "string_searcher.hpp".
+    size_type find(const basic_string_searcher<CharT, Traits>& searcher, size_type pos = 0) const noexcept {
+        return searcher.find(*this, pos);
+    }
+
     constexpr size_type rfind(basic_string_view v, size_type pos = npos) const noexcept {
         return rfind(v.data(), pos, v.size());
     }
@@ -319,6 +341,13 @@ public:
 
         pos = std::min<size_type>(m_size - count, pos);
 
+        if constexpr (byte_search) {
+            if !consteval {
+                const char* result = rfind_substring(m_data, pos + count, s, count);
+                return result ? result - m_data : npos;
+            }
+        }
+
         do {
             if (Traits::compare(m_data + pos, s, count) == 0)
                 return pos;
@@ -332,6 +361,15 @@ public:
     }
 
     constexpr size_type find_first_of(basic_string_view v, size_type pos = 0) const noexcept {
+        if (v.m_size == 1) return find(v.m_data[0], pos);
+        if constexpr (byte_search) {
+            if !consteval {
+                if (pos >= m_size || v.m_size == 0) return npos;
+                const char* result = find_in_set(m_data + pos, m_size - pos,
+                                                 byte_set(v.m_data, v.m_size), true);
+                return result ? result - m_data : npos;
+            }
+        }
         for (size_type i = pos; i < m_size; ++i) {
             if (Traits::find(v.m_data, v.m_size, m_data[i]))
                 return i;
@@ -354,6 +392,13 @@ public:
     constexpr size_type find_last_of(basic_string_view v, size_type pos = npos) const noexcept {
         if (m_size == 0 || v.m_size == 0) return npos;
         size_type last = std::min<size_type>(pos, m_size - 1);
+        if constexpr (byte_search) {
+            if !consteval {
+                const char* result = rfind_in_set(m_data, last + 1,
+                                                  byte_set(v.m_data, v.m_size), true);
+                return result ? result - m_data : npos;
+            }
+        }
         do {
             if (Traits::find(v.m_data, v.m_size, m_data[last]))
                 return last;
@@ -374,6 +419,16 @@ public:
     }
 
     constexpr size_type find_first_not_of(basic_string_view v, size_type pos = 0) const noexcept {
+        if constexpr (byte_search) {
+            if !consteval {
+                if (v.m_size > 1) {
+                    if (pos >= m_size) return npos;
+                    const char* result = find_in_set(m_data + pos, m_size - pos,
+                                                     byte_set(v.m_data, v.m_size), false);
+                    return result ? result - m_data : npos;
+                }
+            }
+        }
         for (size_type i = pos; i < m_size; ++i) {
             if (!Traits::find(v.m_data, v.m_size, m_data[i]))
                 return i;
@@ -396,6 +451,15 @@ public:
     constexpr size_type find_last_not_of(basic_string_view v, size_type pos = npos) const noexcept {
         if (m_size == 0) return npos;
         size_type last = std::min<size_type>(pos, m_size - 1);
+        if constexpr (byte_search) {
+            if !consteval {
+                if (v.m_size > 1) {
+                    const char* result = rfind_in_set(m_data, last + 1,
+                                                      byte_set(v.m_data, v.m_size), false);
+                    return result ? result - m_data : npos;
+                }
+            }
+        }
         do {
             if (!Traits::find(v.m_data, v.m_size, m_data[last]))
                 return last;
@@ -446,6 +510,19 @@ std::basic_ostream<CharT, Traits>&
 using string_view = my::basic_string_view<char>;
 } // namespace my
 
+namespace std {
+template<class CharT, class Traits>
+struct hash<my::basic_string_view<CharT, Traits>> {
+    constexpr size_t operator()(my::basic_string_view<CharT, Traits> v) const noexcept {
+        if constexpr (is_same_v<CharT, char>) {
+            return my::hash_bytes(v.data(), v.size());
+        } else {
+            return my::hash_bytes(reinterpret_cast<const char*>(v.data()), v.size() * sizeof(CharT));
+        }
+    }
+};
+} // namespace std
+
 namespace std::ranges {
 template<class CharT, class Traits>
 inline constexpr bool
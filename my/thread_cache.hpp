@@ -0,0 +1,222 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <vector>
+#include "memory.hpp"
+
+namespace my {
+
+namespace {
+
+// Size classes: 16-byte steps up to 256 bytes, then powers of two up to
+// 32 KiB. Larger blocks bypass the caches.
+inline constexpr std::size_t small_class_limit = 256;
+inline constexpr std::size_t max_cached_size = std::size_t{32} << 10;
+inline constexpr std::size_t size_class_count =
+    small_class_limit / 16 + (std::bit_width(max_cached_size) - std::bit_width(small_class_limit));
+
+constexpr std::size_t size_class_of(std::size_t bytes) noexcept {
+    if (bytes <= small_class_limit) {
+        return (std::max<std::size_t>(bytes, 1) - 1) / 16;
+    }
+    return small_class_limit / 16 - 1 +
+           (std::bit_width(bytes - 1) - std::bit_width(small_class_limit - 1));
+}
+
+constexpr std::size_t class_size(std::size_t size_class) noexcept {
+    if (size_class < small_class_limit / 16) {
+        return (size_class + 1) * 16;
+    }
+    return small_class_limit << (size_class + 1 - small_class_limit / 16);
+}
+
+static_assert(size_class_of(1) == 0 && size_class_of(16) == 0 && size_class_of(17) == 1);
+static_assert(class_size(size_class_of(256)) == 256 && class_size(size_class_of(257)) == 512);
+static_assert(size_class_of(max_cached_size) == size_class_count - 1);
+static_assert(class_size(size_class_count - 1) == max_cached_size);
+
+// Blocks moved between a thread and the central pool at a time: about
+// 16 KiB worth, between 4 and 64 blocks.
+constexpr std::size_t batch_size(std::size_t size_class) noexcept {
+    return std::clamp<std::size_t>((std::size_t{16} << 10) / class_size(size_class), 4, 64);
+}
+
+} // anonymous namespace
+
+// The pools below hold process-wide state, so they need external linkage.
+struct free_node {
+    free_node* next;
+};
+
+struct free_batch {
+    free_node* head;
+    std::size_t count;
+};
+
+// Shared store of free blocks for one size class, kept as whole batches so
+// that a transfer is a single push or pop under the lock. New blocks are
+// carved from spans that are never returned to the system.
+class central_free_list {
+    std::mutex m_mutex;
+    std::vector<free_batch> m_batches;
+    std::size_t m_size_class;
+
+public:
+    explicit central_free_list(std::size_t size_class) noexcept : m_size_class{size_class} {}
+
+    free_batch pop() {
+        {
+            std::lock_guard lock{m_mutex};
+            if (!m_batches.empty()) {
+                free_batch batch = m_batches.back();
+                m_batches.pop_back();
+                return batch;
+            }
+        }
+        return carve();
+    }
+
+    void push(free_batch batch) {
+        std::lock_guard lock{m_mutex};
+        m_batches.push_back(batch);
+    }
+
+private:
+    // fresh span of two batches' worth of blocks, carved outside the lock
+    free_batch carve() {
+        std::size_t size = class_size(m_size_class);
+        std::size_t count = 2 * batch_size(m_size_class);
+        auto* span = static_cast<std::byte*>(::operator new(size * count));
+        free_node* head = nullptr;
+        for (std::size_t i = count; i-- > 0;) {
+            head = ::new (span + i * size) free_node{head};
+        }
+        return { head, count };
+    }
+};
+
+// Leaked on purpose: threads may still free blocks during static destruction.
+inline central_free_list& central_list(std::size_t size_class) {
+    static auto* lists = [] {
+        auto* storage = static_cast<central_free_list*>(
+            ::operator new(sizeof(central_free_list) * size_class_count));
+        for (std::size_t i = 0; i < size_class_count; ++i) {
+            ::new (storage + i) central_free_list{i};
+        }
+        return storage;
+    }();
+    return lists[size_class];
+}
+
+// Per-thread free lists. A thread refills and drains its lists one batch at
+// a time, so the central lock is taken once per batch instead of once per
+// block. On thread exit the cached blocks go back to the central pool.
+class thread_cache {
+    struct free_list {
+        free_node* head = nullptr;
+        std::size_t count = 0;
+    };
+    std::array<free_list, size_class_count> m_lists{};
+
+public:
+    thread_cache() = default;
+    thread_cache(const thread_cache&) = delete;
+    thread_cache& operator=(const thread_cache&) = delete;
+
+    ~thread_cache() {
+        for (std::size_t c = 0; c < size_class_count; ++c) {
+            if (m_lists[c].count > 0) {
+                central_list(c).push({ m_lists[c].head, m_lists[c].count });
+                m_lists[c] = {};
+            }
+        }
+    }
+
+    void* allocate(std::size_t size_class) {
+        free_list& list = m_lists[size_class];
+        if (list.head == nullptr) {
+            free_batch batch = central_list(size_class).pop();
+            list.head = batch.head;
+            list.count = batch.count;
+        }
+        free_node* node = list.head;
+        list.head = node->next;
+        --list.count;
+        return node;
+    }
+
+    void deallocate(void* p, std::size_t size_class) {
+        free_list& list = m_lists[size_class];
+        list.head = ::new (p) free_node{list.head};
+        ++list.count;
+        // keep one batch at hand, hand the one above it back
+        std::size_t batch = batch_size(size_class);
+        if (list.count >= 2 * batch) {
+            free_node* last = list.head;
+            for (std::size_t i = 1; i < batch; ++i) {
+                last = last->next;
+            }
+            central_list(size_class).push({ list.head, batch });
+            list.head = std::exchange(last->next, nullptr);
+            list.count -= batch;
+        }
+    }
+
+    // Null while the thread is being torn down, once the cache is gone.
+    static thread_cache* local() noexcept {
+        thread_local bool destroyed = false;
+        thread_local struct holder {
+            thread_cache cache;
+            ~holder() { destroyed = true; }
+        } h;
+        return destroyed ? nullptr : &h.cache;
+    }
+}; // class thread_cache
+
+// my::allocator backend with per-thread free lists per size class, backed
+// by a central pool that is only touched one batch at a time. Blocks of up
+// to 32 KiB are cached; larger ones go to ::operator new. Memory may be
+// freed by a different thread than the one that allocated it.
+struct thread_cache_backend {
+    static void* allocate(std::size_t bytes) {
+        if (bytes > max_cached_size) {
+            return ::operator new(bytes);
+        }
+        std::size_t size_class = size_class_of(bytes);
+        if (thread_cache* cache = thread_cache::local()) {
+            return cache->allocate(size_class);
+        }
+        free_batch batch = central_list(size_class).pop();
+        if (batch.count > 1) {
+            central_list(size_class).push({ batch.head->next, batch.count - 1 });
+        }
+        return batch.head;
+    }
+
+    static void deallocate(void* p, std::size_t bytes) noexcept {
+        if (bytes > max_cached_size) {
+            ::operator delete(p, bytes);
+            return;
+        }
+        std::size_t size_class = size_class_of(bytes);
+        if (thread_cache* cache = thread_cache::local()) {
+            cache->deallocate(p, size_class);
+        } else {
+            central_list(size_class).push({ ::new (p) free_node{nullptr}, 1 });
+        }
+    }
+
+    static constexpr std::size_t good_size(std::size_t bytes) noexcept {
+        return (bytes > max_cached_size) ? malloc_size_class(bytes)
+                                         : class_size(size_class_of(bytes));
+    }
+};
+
+template<class T>
+using thread_cached_allocator = allocator<T, thread_cache_backend>;
+
+} // namespace my
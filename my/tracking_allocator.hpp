@@ -0,0 +1,238 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+#include "memory.hpp"
+
+namespace my {
+
+// Snapshot of the allocations made through the tracking allocators of one tag.
+struct allocation_stats {
+    std::uint64_t allocations = 0;
+    std::uint64_t deallocations = 0;
+    std::int64_t live_bytes = 0;
+    // highest live_bytes seen so far, whichever threads allocate and free
+    std::uint64_t peak_bytes = 0;
+    // histogram[k] counts blocks of (2^(k-1), 2^k] bytes; [0] counts 0 and 1.
+    std::array<std::uint64_t, 64> histogram{};
+};
+
+// Counters of one thread. Only the owning thread writes them; the relaxed
+// atomics let other threads read them while it runs. Live bytes are not
+// kept here: a block is often freed by another thread than the one that
+// allocated it, so only a shared total gives a true peak.
+struct tracking_counters {
+    std::atomic<std::uint64_t> allocations{0};
+    std::atomic<std::uint64_t> deallocations{0};
+    std::array<std::atomic<std::uint64_t>, 64> histogram{};
+
+    void on_allocate(std::size_t bytes) noexcept {
+        auto relaxed = std::memory_order_relaxed;
+        allocations.store(allocations.load(relaxed) + 1, relaxed);
+        auto& bucket = histogram[bytes <= 1 ? 0 : std::bit_width(bytes - 1)];
+        bucket.store(bucket.load(relaxed) + 1, relaxed);
+    }
+
+    void on_deallocate() noexcept {
+        auto relaxed = std::memory_order_relaxed;
+        deallocations.store(deallocations.load(relaxed) + 1, relaxed);
+    }
+
+    void add_to(allocation_stats& stats) const noexcept {
+        auto relaxed = std::memory_order_relaxed;
+        stats.allocations += allocations.load(relaxed);
+        stats.deallocations += deallocations.load(relaxed);
+        for (std::size_t k = 0; k < histogram.size(); ++k) {
+            stats.histogram[k] += histogram[k].load(relaxed);
+        }
+    }
+};
+
+// Registry of the per-thread counters of one tag. Threads register on their
+// first allocation; on exit their totals move into a retired record. Live
+// and peak bytes are shared by all threads of the tag, so every allocation
+// and free pays one atomic add on them.
+template<class Tag>
+class tracking_registry {
+    std::mutex m_mutex;
+    std::vector<const tracking_counters*> m_threads;
+    allocation_stats m_retired;
+
+    // constant-initialized, so usable from any thread at any time
+    static inline std::atomic<std::int64_t> s_live_bytes{0};
+    static inline std::atomic<std::uint64_t> s_peak_bytes{0};
+
+    struct thread_slot {
+        tracking_counters counters;
+        thread_slot() { instance().attach(&counters); }
+        ~thread_slot() { instance().retire(&counters); }
+    };
+
+public:
+    // leaked on purpose: threads may still free blocks during static destruction
+    static tracking_registry& instance() {
+        static auto* registry = new tracking_registry{};
+        return *registry;
+    }
+
+    static void record_allocate(std::size_t bytes) {
+        auto relaxed = std::memory_order_relaxed;
+        auto live = s_live_bytes.fetch_add(static_cast<std::int64_t>(bytes), relaxed) +
+                    static_cast<std::int64_t>(bytes);
+        auto peak = s_peak_bytes.load(relaxed);
+        while (live > 0 && static_cast<std::uint64_t>(live) > peak &&
+               !s_peak_bytes.compare_exchange_weak(peak, static_cast<std::uint64_t>(live),
+                                                   relaxed)) {}
+        if (tracking_counters* counters = local()) {
+            counters->on_allocate(bytes);
+        } else {
+            instance().record_retired(bytes, true);
+        }
+    }
+
+    static void record_deallocate(std::size_t bytes) noexcept {
+        s_live_bytes.fetch_sub(static_cast<std::int64_t>(bytes), std::memory_order_relaxed);
+        if (tracking_counters* counters = local()) {
+            counters->on_deallocate();
+        } else {
+            instance().record_retired(bytes, false);
+        }
+    }
+
+    allocation_stats snapshot() {
+        std::lock_guard lock{m_mutex};
+        allocation_stats stats = m_retired;
+        for (const tracking_counters* counters : m_threads) {
+            counters->add_to(stats);
+        }
+        stats.live_bytes = s_live_bytes.load(std::memory_order_relaxed);
+        stats.peak_bytes = s_peak_bytes.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+private:
+    // Null while the thread is being torn down, once its slot is gone.
+    static tracking_counters* local() noexcept {
+        thread_local bool destroyed = false;
+        thread_local struct holder {
+            thread_slot slot;
+            ~holder() { destroyed = true; }
+        } h;
+        return destroyed ? nullptr : &h.slot.counters;
+    }
+
+    void attach(const tracking_counters* counters) {
+        std::lock_guard lock{m_mutex};
+        m_threads.push_back(counters);
+    }
+
+    void retire(const tracking_counters* counters) noexcept {
+        std::lock_guard lock{m_mutex};
+        counters->add_to(m_retired);
+        std::erase(m_threads, counters);
+    }
+
+    void record_retired(std::size_t bytes, bool allocated) noexcept {
+        std::lock_guard lock{m_mutex};
+        if (allocated) {
+            ++m_retired.allocations;
+            ++m_retired.histogram[bytes <= 1 ? 0 : std::bit_width(bytes - 1)];
+        } else {
+            ++m_retired.deallocations;
+        }
+    }
+}; // class tracking_registry
+
+// Wraps any allocator and records every block it hands out in thread-local
+// counters, aggregated per Tag by stats(). Behaves like Alloc otherwise,
+// propagation traits and reallocate included.
+template<class Alloc, class Tag = void>
+class tracking_allocator {
+    using alloc_traits = std::allocator_traits<Alloc>;
+    using registry = tracking_registry<Tag>;
+
+    [[no_unique_address]] Alloc m_alloc;
+
+    template<class, class> friend class tracking_allocator;
+public:
+    using value_type      = typename alloc_traits::value_type;
+    using size_type       = typename alloc_traits::size_type;
+    using difference_type = typename alloc_traits::difference_type;
+    using propagate_on_container_copy_assignment =
+        typename alloc_traits::propagate_on_container_copy_assignment;
+    using propagate_on_container_move_assignment =
+        typename alloc_traits::propagate_on_container_move_assignment;
+    using propagate_on_container_swap = typename alloc_traits::propagate_on_container_swap;
+    using is_always_equal             = typename alloc_traits::is_always_equal;
+
+    template<class U>
+    struct rebind {
+        using other = tracking_allocator<typename alloc_traits::template rebind_alloc<U>, Tag>;
+    };
+
+    // constructors
+    constexpr tracking_allocator() requires std::default_initializable<Alloc> = default;
+    constexpr tracking_allocator(const Alloc& alloc) : m_alloc{alloc} {}
+    template<class OtherAlloc>
+    constexpr tracking_allocator(const tracking_allocator<OtherAlloc, Tag>& other) :
+        m_alloc{other.m_alloc} {}
+
+    constexpr size_type max_size() const noexcept {
+        return alloc_traits::max_size(m_alloc);
+    }
+
+    value_type* allocate(size_type n) {
+        value_type* p = alloc_traits::allocate(m_alloc, n);
+        registry::record_allocate(n * sizeof(value_type));
+        return p;
+    }
+
+    allocation_result<value_type*, size_type> allocate_at_least(size_type n) {
+        auto [ptr, count] = my::allocate_at_least(m_alloc, n);
+        registry::record_allocate(count * sizeof(value_type));
+        return { ptr, count };
+    }
+
+    void deallocate(value_type* p, size_type n) noexcept {
+        alloc_traits::deallocate(m_alloc, p, n);
+        registry::record_deallocate(n * sizeof(value_type));
+    }
+
+    allocation_result<value_type*, size_type> reallocate(value_type* p, size_type old_n,
+                                                         size_type new_n) noexcept
+        requires reallocating_allocator<Alloc>
+    {
+        auto result = m_alloc.reallocate(p, old_n, new_n);
+        if (result.ptr != nullptr) {
+            registry::record_deallocate(old_n * sizeof(value_type));
+            registry::record_allocate(result.count * sizeof(value_type));
+        }
+        return result;
+    }
+
+    constexpr tracking_allocator select_on_container_copy_construction() const {
+        return tracking_allocator{alloc_traits::select_on_container_copy_construction(m_alloc)};
+    }
+
+    constexpr const Alloc& underlying() const noexcept {
+        return m_alloc;
+    }
+
+    static allocation_stats stats() {
+        return registry::instance().snapshot();
+    }
+
+    template<class OtherAlloc>
+    constexpr bool operator==(const tracking_allocator<OtherAlloc, Tag>& other) const noexcept {
+        return m_alloc == other.m_alloc;
+    }
+}; // class tracking_allocator
+
+} // namespace my
@@ -1,9 +1,15 @@
 #pragma once
+#include <algorithm>
+#include <concepts>
+#include <cstring>
+#include <functional>
 #include <print>
+#include <ranges>
 #include <type_traits>
 #include <utility>
 #include <format>
 #include <string_view>
+#include "hash_combine.hpp"
 
 namespace my {
 
@@ -19,6 +25,49 @@ constexpr T exchange( T& obj, U&& new_value )
     return old_value;
 }
 
+// Types whose objects may be moved to a new address by copying their bytes,
+// after which the source is treated as dead storage (no destructor call).
+// Trivially copyable types qualify; other types opt in by specializing.
+template<class T>
+struct is_trivially_relocatable
+    : std::bool_constant<std::is_trivially_copyable_v<T>> {};
+
+template<class T>
+inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+// Ranges whose elements a container of T can be built from.
+template<class R, class T>
+concept container_compatible_range =
+    std::ranges::input_range<R> &&
+    std::convertible_to<std::ranges::range_reference_t<R>, T>;
+
+namespace {
+
+// std::remove_if that slides each run of kept trivially copyable elements
+// down with a single memmove.
+template<class T, class Pred>
+constexpr T* remove_if_runs(T* first, T* last, Pred& pred) {
+    first = std::find_if(first, last, pred);
+    if (first == last) return last;
+    if constexpr (std::is_trivially_copyable_v<T>) {
+        if !consteval {
+            T* out = first;
+            T* in = first + 1;
+            while (in != last) {
+                T* run_end = std::find_if(in, last, pred);
+                std::size_t n = static_cast<std::size_t>(run_end - in);
+                std::memmove(static_cast<void*>(out), static_cast<const void*>(in), n * sizeof(T));
+                out += n;
+                in = (run_end == last) ? last : run_end + 1;
+            }
+            return out;
+        }
+    }
+    return std::remove_if(first, last, pred);
+}
+
+} // anonymous namespace
+
 template<class T1, class T2>
 struct pair {
     T1 first;
@@ -127,6 +176,11 @@ struct pair {
     }
 }; // class pair
 
+template<class T1, class T2>
+struct is_trivially_relocatable<pair<T1, T2>>
+    : std::bool_constant<is_trivially_relocatable_v<T1> &&
+                         is_trivially_relocatable_v<T2>> {};
+
 template<class T1, class T2>
 constexpr pair<std::unwrap_ref_decay_t<T1>, std::unwrap_ref_decay_t<T2>>
 make_pair(T1&& x, T2&& y) {
@@ -148,6 +202,16 @@ constexpr auto operator<=>(const pair<T1, T2>& lhs, const pair<U1, U2>& rhs) {
 
 namespace std {
 
+template<class T1, class T2>
+    requires requires(const T1& a, const T2& b) { hash<T1>{}(a); hash<T2>{}(b); }
+struct hash<my::pair<T1, T2>> {
+    constexpr size_t operator()(const my::pair<T1, T2>& p) const
+        noexcept(noexcept(hash<T1>{}(p.first)) && noexcept(hash<T2>{}(p.second)))
+    {
+        return my::hash_combine(hash<T1>{}(p.first), hash<T2>{}(p.second));
+    }
+};
+
 template <class T1, class T2>
 struct formatter<my::pair<T1, T2>> : formatter<string_view> {
     auto format(const my::pair<T1, T2>& p, format_context& ctx) const {
@@ -0,0 +1,831 @@
+#pragma once
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <print>
+#include <ranges>
+#include <stdexcept>
+#include <cassert>
+#include "growth_policy.hpp"
+#include "memory.hpp"
+#include "utility.hpp"
+
+namespace my {
+
+// Growth, relocation, range, erase and allocator propagation shared by
+// my::vector and my::small_vector. Storage decides where the elements live
+// before the first heap allocation, and where they go back to when they fit
+// again: it provides an inline buffer of Storage::capacity elements at
+// Storage::data(). my::vector uses an empty one at nullptr, so that "inline"
+// there simply means "no buffer yet". Every heap buffer comes from
+// Allocator.
+template<class T, class Allocator, class GrowthPolicy, class Storage>
+class vector_base {
+public:
+    using value_type             = T;
+    using allocator_type         = Allocator;
+    using growth_policy          = GrowthPolicy;
+    using size_type              = std::size_t;
+    using difference_type        = std::ptrdiff_t;
+    using reference              = value_type&;
+    using const_reference        = const value_type&;
+    using pointer                = value_type*;
+    using const_pointer          = const value_type*;
+    using iterator               = value_type*;
+    using const_iterator         = const value_type*;
+    using reverse_iterator       = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+private:
+    pointer m_st;
+    size_type m_sz;
+    size_type m_cap;
+    [[no_unique_address]] allocator_type m_alloc;
+    [[no_unique_address]] Storage m_storage;
+
+    using alloc_traits = std::allocator_traits<Allocator>;
+
+    // elements can follow their heap buffer through allocator.reallocate
+    static constexpr bool can_reallocate =
+        reallocating_allocator<Allocator> && is_trivially_relocatable_v<T>;
+public:
+    // For debug purpose only
+    void show() {
+        std::print("[");
+        for (size_type i = 0; i < m_sz; ++i) {
+            std::print("{}, ", m_st[i]);
+        }
+        std::println("]");
+        std::println("m_st: {}, m_sz: {}, m_cap: {}", static_cast<void*>(begin()), size(), capacity());
+    }
+
+    // constructors
+    constexpr vector_base() : vector_base(Allocator()) {}
+
+    constexpr explicit vector_base(const Allocator& alloc) noexcept :
+        m_st{nullptr}, m_sz{0}, m_cap{Storage::capacity}, m_alloc{alloc}
+    {
+        m_st = m_storage.data();
+    }
+
+    explicit vector_base(size_type count, const Allocator& alloc = Allocator()) :
+        vector_base(count, T(), alloc) {}
+
+    constexpr vector_base(size_type count, const T& value,
+        const Allocator& alloc = Allocator()) : vector_base(alloc)
+    {
+        allocate_exactly(count);
+        std::uninitialized_fill_n(m_st, count, value);
+        m_sz = count;
+    }
+
+    template<class InputIt>
+    constexpr vector_base(InputIt first, InputIt last, const Allocator& alloc = Allocator())
+        requires std::input_iterator<InputIt>
+    : vector_base(alloc)
+    {
+        size_type count = static_cast<size_type>(std::distance(first, last));
+        allocate_exactly(count);
+        std::uninitialized_copy(first, last, m_st);
+        m_sz = count;
+    }
+
+    constexpr vector_base(const vector_base& other) :
+        vector_base(other, alloc_traits::select_on_container_copy_construction(other.m_alloc)) {}
+
+    constexpr vector_base(const vector_base& other, const Allocator& alloc) : vector_base(alloc) {
+        allocate_exactly(other.m_sz);
+        std::uninitialized_copy(other.cbegin(), other.cend(), m_st);
+        m_sz = other.m_sz;
+    }
+
+    // Steals a heap buffer, relocates inline elements.
+    constexpr vector_base(vector_base&& other) noexcept :
+        m_st{nullptr}, m_sz{0}, m_cap{Storage::capacity}, m_alloc{std::move(other.m_alloc)}
+    {
+        m_st = m_storage.data();
+        take_elements(other);
+    }
+
+    // Steals the buffer when alloc can free it, moves element-wise otherwise.
+    constexpr vector_base(vector_base&& other, const Allocator& alloc) : vector_base(alloc) {
+        if (alloc_traits::is_always_equal::value || m_alloc == other.m_alloc) {
+            take_storage(other);
+        } else {
+            append_range(std::ranges::subrange(std::make_move_iterator(other.begin()),
+                                               std::make_move_iterator(other.end())));
+        }
+    }
+
+    vector_base(std::initializer_list<T> init,
+        const Allocator& alloc = Allocator()) : vector_base{init.begin(), init.end(), alloc} {}
+
+    constexpr allocator_type get_allocator() const noexcept {
+        return m_alloc;
+    }
+
+    // destructor
+    constexpr ~vector_base() {
+        std::destroy(begin(), end());
+        release();
+    }
+
+    // assignment
+    constexpr vector_base& operator=(const vector_base& other) {
+        if (this == &other) {
+            return *this;
+        }
+        if constexpr (alloc_traits::propagate_on_container_copy_assignment::value) {
+            if (!alloc_traits::is_always_equal::value && m_alloc != other.m_alloc) {
+                // the old buffer can only go back to the old allocator
+                clear();
+                release();
+                m_st = m_storage.data();
+                m_cap = Storage::capacity;
+            }
+            m_alloc = other.m_alloc;
+        }
+        assign_range(other);
+        return *this;
+    }
+
+    constexpr vector_base& operator=(vector_base&& other)
+        noexcept(alloc_traits::propagate_on_container_move_assignment::value ||
+                 alloc_traits::is_always_equal::value)
+    {
+        if (this == &other) {
+            return *this;
+        }
+        if (alloc_traits::propagate_on_container_move_assignment::value ||
+            alloc_traits::is_always_equal::value || m_alloc == other.m_alloc) {
+            take_storage(other);
+            if constexpr (alloc_traits::propagate_on_container_move_assignment::value) {
+                m_alloc = std::move(other.m_alloc);
+            }
+        } else {
+            // a buffer from another allocator cannot be adopted
+            assign_range(std::ranges::subrange(std::make_move_iterator(other.begin()),
+                                               std::make_move_iterator(other.end())));
+        }
+        return *this;
+    }
+
+    constexpr vector_base& operator=(std::initializer_list<T> ilist) {
+        assign_range(ilist);
+        return *this;
+    }
+
+    // element access
+    constexpr reference at(size_type pos) {
+        if (pos >= m_sz) {
+            throw std::out_of_range("Index out of range");
+        } else {
+            return m_st[pos];
+        }
+    }
+
+    constexpr reference operator[](size_type pos) {
+        return m_st[pos];
+    }
+
+    constexpr const_reference operator[](size_type pos) const {
+        return m_st[pos];
+    }
+
+    constexpr reference front() {
+        return m_st[0];
+    }
+
+    constexpr const_reference front() const {
+        return m_st[0];
+    }
+
+    constexpr reference back() {
+        return m_st[m_sz - 1];
+    }
+
+    constexpr const_reference back() const {
+        return m_st[m_sz - 1];
+    }
+
+    constexpr pointer data() noexcept {
+        return m_st;
+    }
+
+    constexpr const_pointer data() const noexcept {
+        return m_st;
+    }
+    // iterators
+    constexpr iterator begin() noexcept {
+        return m_st;
+    }
+
+    constexpr const_iterator begin() const noexcept {
+        return m_st;
+    }
+
+    constexpr const_iterator cbegin() const noexcept {
+        return m_st;
+    }
+
+    constexpr iterator end() noexcept {
+        return m_st + m_sz;
+    }
+
+    constexpr const_iterator end() const noexcept {
+        return m_st + m_sz;
+    }
+
+    constexpr const_iterator cend() const noexcept {
+        return m_st + m_sz;
+    }
+
+    constexpr reverse_iterator rbegin() noexcept {
+        return reverse_iterator(end());
+    }
+
+    constexpr const_reverse_iterator rbegin() const noexcept {
+        return const_reverse_iterator(end());
+    }
+
+    constexpr const_reverse_iterator crbegin() const noexcept {
+        return const_reverse_iterator(end());
+    }
+
+    constexpr reverse_iterator rend() noexcept {
+        return reverse_iterator(begin());
+    }
+
+    constexpr const_reverse_iterator rend() const noexcept {
+        return const_reverse_iterator(begin());
+    }
+
+    constexpr const_reverse_iterator crend() const noexcept {
+        return const_reverse_iterator(begin());
+    }
+
+    // capacity
+    constexpr bool empty() const noexcept {
+        return m_sz == 0;
+    }
+
+    constexpr size_type size() const noexcept {
+        return m_sz;
+    }
+
+    constexpr size_type max_size() const noexcept {
+        return std::min<size_type>(std::allocator_traits<Allocator>::max_size(m_alloc),
+                                   std::numeric_limits<difference_type>::max() / sizeof(T));
+    }
+
+    void reserve(size_type new_cap) {
+        if (new_cap > max_size()) {
+            throw std::length_error("Try to allocate space larger than max_size()");
+        } else if (new_cap > m_cap) {
+            grow_to(new_cap);
+        } else {
+            return;
+        }
+    }
+
+    // Moves the elements back inline when they fit; an empty my::vector
+    // gives its buffer back.
+    constexpr void shrink_to_fit() {
+        if (m_sz == m_cap || is_inline()) {
+            return;
+        } else {
+            shrink_to(m_sz);
+        }
+    }
+
+    constexpr size_type capacity() const noexcept {
+        return m_cap;
+    }
+
+    // Bytes of the buffer taken by elements, and reserved beyond them;
+    // inline storage counts as reserved.
+    constexpr memory_usage_info memory_usage() const noexcept {
+        return { m_sz * sizeof(T), (m_cap - m_sz) * sizeof(T) };
+    }
+
+    constexpr void resize(size_type count) {
+        if (count <= m_sz) {
+            std::destroy(begin() + count, end());
+        } else {
+            if (count > m_cap) {
+                grow_to(next_capacity(count - m_sz));
+            }
+            std::uninitialized_value_construct_n(end(), count - m_sz);
+        }
+        m_sz = count;
+    }
+
+    constexpr void resize(size_type count, const value_type& value) {
+        if (count <= m_sz) {
+            std::destroy(begin() + count, end());
+            m_sz = count;
+        } else {
+            insert(cend(), count - m_sz, value);
+        }
+    }
+
+    // Like resize, but new elements are default-initialized: trivial types
+    // are left uninitialized for the caller to overwrite.
+    constexpr void resize_for_overwrite(size_type count) {
+        if (count <= m_sz) {
+            std::destroy(begin() + count, end());
+        } else {
+            if (count > m_cap) {
+                grow_to(next_capacity(count - m_sz));
+            }
+            std::uninitialized_default_construct_n(end(), count - m_sz);
+        }
+        m_sz = count;
+    }
+
+    // Resizes to `count` default-initialized elements, then calls
+    // op(data(), count) to fill them. op returns the new size, which
+    // must not exceed `count`; the elements past it are destroyed.
+    template<class Operation>
+    constexpr void resize_and_overwrite(size_type count, Operation op) {
+        resize_for_overwrite(count);
+        auto new_sz = static_cast<size_type>(std::move(op)(data(), count));
+        assert(new_sz <= count && "resize_and_overwrite operation overflowed");
+        resize_for_overwrite(new_sz);
+    }
+
+    // modifiers
+    constexpr void clear() noexcept {
+        std::destroy(begin(), end());
+        m_sz = 0;
+    }
+
+    constexpr void assign(size_type count, const T& value) {
+        if (count > m_cap) {
+            // fill before the old elements die: value may be one of them
+            auto new_buf = allocate_filled(count, [&](pointer p) {
+                std::uninitialized_fill_n(p, count, value);
+            });
+            replace_with(new_buf, count);
+        } else if (count > m_sz) {
+            std::fill(begin(), end(), value);
+            std::uninitialized_fill_n(end(), count - m_sz, value);
+            m_sz = count;
+        } else {
+            std::fill_n(begin(), count, value);
+            std::destroy(begin() + count, end());
+            m_sz = count;
+        }
+    }
+
+    template<class InputIt>
+    constexpr void assign(InputIt first, InputIt last)
+        requires std::input_iterator<InputIt>
+    {
+        assign_range(std::ranges::subrange(first, last));
+    }
+
+    constexpr void assign(std::initializer_list<T> ilist) {
+        assign_range(ilist);
+    }
+
+    // Sized and forward ranges are copied with at most one allocation.
+    template<container_compatible_range<T> R>
+    constexpr void assign_range(R&& rg) {
+        if constexpr (std::ranges::forward_range<R> || std::ranges::sized_range<R>) {
+            auto count = static_cast<size_type>(std::ranges::distance(rg));
+            auto first = std::ranges::begin(rg);
+            if (count > m_cap) {
+                auto new_buf = allocate_filled(count, [&](pointer p) {
+                    std::ranges::uninitialized_copy_n(std::move(first), count, p, std::unreachable_sentinel);
+                });
+                replace_with(new_buf, count);
+            } else if (count > m_sz) {
+                auto rest = std::ranges::copy_n(std::move(first), m_sz, begin()).in;
+                std::ranges::uninitialized_copy_n(std::move(rest), count - m_sz,
+                                                  end(), std::unreachable_sentinel);
+                m_sz = count;
+            } else {
+                std::ranges::copy_n(std::move(first), count, begin());
+                std::destroy(begin() + count, end());
+                m_sz = count;
+            }
+        } else {
+            clear();
+            append_range(std::forward<R>(rg));
+        }
+    }
+
+    constexpr iterator insert(const_iterator pos, const_reference value) {
+        size_type offset = static_cast<size_type>(std::distance(cbegin(), pos));
+        assert(offset <= m_sz && "Inserted position invalid");
+        if (m_sz == m_cap) {
+            size_type new_cap = next_capacity(1);
+            if constexpr (can_reallocate) {
+                // value may be an element, which reallocate would invalidate
+                value_type copy(value);
+                grow_to(new_cap);
+                return insert(cbegin() + offset, std::move(copy));
+            }
+            auto new_buf = allocate_filled(new_cap, [&](pointer p) {
+                std::construct_at(p + offset, value);
+            });
+            relocate_to(new_buf, offset, 1);
+        } else if (pos == cend()) {
+            std::construct_at(end(), value);
+        } else {
+            std::construct_at(end(), std::move(back()));
+            std::move_backward(begin() + offset, end() - 1, end());
+            *(m_st + offset) = value;
+        }
+        m_sz++;
+        return m_st + offset;
+    }
+
+    constexpr iterator insert(const_iterator pos, T&& value) {
+        size_type offset = static_cast<size_type>(std::distance(cbegin(), pos));
+        assert(offset <= m_sz && "Inserted position invalid");
+        if (m_sz == m_cap) {
+            size_type new_cap = next_capacity(1);
+            if constexpr (can_reallocate) {
+                value_type moved(std::move(value));
+                grow_to(new_cap);
+                return insert(cbegin() + offset, std::move(moved));
+            }
+            auto new_buf = allocate_filled(new_cap, [&](pointer p) {
+                std::construct_at(p + offset, std::move(value));
+            });
+            relocate_to(new_buf, offset, 1);
+        } else if (pos == cend()) {
+            std::construct_at(end(), std::move(value));
+        } else {
+            std::construct_at(end(), std::move(back()));
+            std::move_backward(begin() + offset, end() - 1, end());
+            *(m_st + offset) = std::move(value);
+        }
+        m_sz++;
+        return m_st + offset;
+    }
+
+    iterator insert(const_iterator pos, size_type count, const T& value) {
+        if (count == 0)
+            return const_cast<iterator>(pos);
+        size_type offset = static_cast<size_type>(std::distance(cbegin(), pos));
+        assert(offset <= m_sz && "Inserted position invalid");
+        if (m_sz + count > m_cap) {
+            size_type new_cap = next_capacity(count);
+            if constexpr (can_reallocate) {
+                value_type copy(value);
+                grow_to(new_cap);
+                return insert(cbegin() + offset, count, copy);
+            }
+            auto new_buf = allocate_filled(new_cap, [&](pointer p) {
+                std::uninitialized_fill_n(p + offset, count, value);
+            });
+            relocate_to(new_buf, offset, count);
+        } else if (offset + count >= m_sz) {
+            std::uninitialized_move(begin() + offset, end(), begin() + offset + count);
+            std::fill_n(begin() + offset, m_sz - offset, value);
+            std::uninitialized_fill_n(end(), count + offset - m_sz, value);
+        } else {
+            std::uninitialized_move(end() - count, end(), end());
+            std::move_backward(begin() + offset, end() - count, end());
+            std::fill_n(begin() + offset, count, value);
+        }
+        m_sz += count;
+        return m_st + offset;
+    }
+
+    template<class InputIt>
+    iterator insert(const_iterator pos, InputIt first, InputIt last)
+        requires std::input_iterator<InputIt>
+    {
+        return insert_range(pos, std::ranges::subrange(first, last));
+    }
+
+    iterator insert(const_iterator pos, std::initializer_list<T> ilist) {
+        return insert_range(pos, ilist);
+    }
+
+    // Sized and forward ranges are inserted with at most one allocation.
+    // Single-pass ranges are appended through the spare capacity, which
+    // grows geometrically, and then rotated into place.
+    template<container_compatible_range<T> R>
+    constexpr iterator insert_range(const_iterator pos, R&& rg) {
+        size_type offset = static_cast<size_type>(std::distance(cbegin(), pos));
+        assert(offset <= m_sz && "Inserted position invalid");
+        if constexpr (std::ranges::forward_range<R> || std::ranges::sized_range<R>) {
+            auto count = static_cast<size_type>(std::ranges::distance(rg));
+            return insert_n(offset, std::ranges::begin(rg), count);
+        } else {
+            size_type old_sz = m_sz;
+            for (auto&& elem : rg) {
+                emplace_back(std::forward<decltype(elem)>(elem));
+            }
+            std::rotate(begin() + offset, begin() + old_sz, end());
+            return begin() + offset;
+        }
+    }
+
+    template<container_compatible_range<T> R>
+    constexpr void append_range(R&& rg) {
+        insert_range(cend(), std::forward<R>(rg));
+    }
+
+    constexpr void push_back(const_reference value) { emplace_back(value); }
+
+    constexpr void push_back(value_type &&value) {
+        emplace_back(std::move(value));
+    }
+
+    template<class... Args>
+    constexpr reference emplace_back(Args&&... args) {
+        if (m_sz == m_cap) {
+            size_type new_cap = next_capacity(1);
+            if constexpr (can_reallocate) {
+                // args may refer to an element, which reallocate would invalidate
+                value_type value(std::forward<Args>(args)...);
+                grow_to(new_cap);
+                return *std::construct_at(m_st + (m_sz++), std::move(value));
+            }
+            // construct first: args may refer to an element of this vector
+            auto new_buf = allocate_filled(new_cap, [&](pointer p) {
+                std::construct_at(p + m_sz, std::forward<Args>(args)...);
+            });
+            relocate_to(new_buf);
+            return m_st[m_sz++];
+        }
+        return *std::construct_at(m_st + (m_sz++), std::forward<Args>(args)...);
+    }
+
+    constexpr void pop_back() {
+        if (empty()) {
+            return;
+        }
+        std::destroy_at(m_st + m_sz - 1);
+        m_sz--;
+        if constexpr (requires { GrowthPolicy::shrink(m_sz, m_cap); }) {
+            size_type new_cap = GrowthPolicy::shrink(m_sz, m_cap);
+            if (new_cap < m_cap && !is_inline()) {
+                shrink_to(std::max(new_cap, m_sz));
+            }
+        }
+    }
+
+    constexpr iterator erase(const_iterator pos) {
+        return erase(pos, pos + 1);
+    }
+
+    constexpr iterator erase(const_iterator first, const_iterator last) {
+        iterator gap = begin() + (first - cbegin());
+        iterator tail = begin() + (last - cbegin());
+        if (gap == tail) {
+            return gap;
+        }
+        if constexpr (is_trivially_relocatable_v<T>) {
+            if !consteval {
+                // destroy the gap, then slide the tail down in one memmove
+                std::destroy(gap, tail);
+                std::memmove(static_cast<void*>(gap), static_cast<const void*>(tail),
+                             static_cast<size_type>(end() - tail) * sizeof(T));
+                m_sz -= static_cast<size_type>(tail - gap);
+                return gap;
+            }
+        }
+        std::destroy(std::move(tail, end(), gap), end());
+        m_sz -= static_cast<size_type>(tail - gap);
+        return gap;
+    }
+
+    // Allocators are swapped only when they propagate on swap; otherwise
+    // they must compare equal.
+    constexpr void swap(vector_base& other) noexcept {
+        if (this == &other) {
+            return;
+        }
+        if constexpr (alloc_traits::propagate_on_container_swap::value) {
+            using std::swap;
+            swap(m_alloc, other.m_alloc);
+        } else {
+            assert((alloc_traits::is_always_equal::value || m_alloc == other.m_alloc) &&
+                   "Swapped vectors with unequal allocators");
+        }
+        if (!is_inline() && !other.is_inline()) {
+            std::swap(m_st, other.m_st);
+            std::swap(m_sz, other.m_sz);
+            std::swap(m_cap, other.m_cap);
+        } else if (is_inline() && other.is_inline()) {
+            vector_base& longer = (m_sz >= other.m_sz) ? *this : other;
+            vector_base& shorter = (m_sz >= other.m_sz) ? other : *this;
+            std::swap_ranges(shorter.begin(), shorter.end(), longer.begin());
+            my::uninitialized_relocate(longer.begin() + shorter.m_sz, longer.end(), shorter.end());
+            std::swap(m_sz, other.m_sz);
+        } else {
+            vector_base& on_heap = is_inline() ? other : *this;
+            vector_base& in_place = is_inline() ? *this : other;
+            pointer heap_st = my::exchange(on_heap.m_st, on_heap.m_storage.data());
+            size_type heap_cap = my::exchange(on_heap.m_cap, Storage::capacity);
+            my::uninitialized_relocate(in_place.begin(), in_place.end(), on_heap.m_st);
+            in_place.m_st = heap_st;
+            in_place.m_cap = heap_cap;
+            std::swap(m_sz, other.m_sz);
+        }
+    }
+
+protected:
+    // true while the elements live in the inline buffer
+    constexpr bool is_inline() const noexcept {
+        return m_st == m_storage.data();
+    }
+
+private:
+    // Capacity that fits `count` more elements, as picked by the growth policy.
+    constexpr size_type next_capacity(size_type count) const {
+        if (count > max_size() - m_sz) {
+            throw std::length_error("Try to allocate space larger than max_size()");
+        }
+        size_type required = m_sz + count;
+        return std::clamp(GrowthPolicy::grow(m_cap, required, sizeof(T)), required, max_size());
+    }
+
+    // Inserts `count` elements read from `first` at `offset`.
+    template<class It>
+    constexpr iterator insert_n(size_type offset, It first, size_type count) {
+        if (count == 0) {
+            return begin() + offset;
+        }
+        if (m_sz + count > m_cap) {
+            size_type new_cap = next_capacity(count);
+            if (!try_reallocate(new_cap)) {
+                auto new_buf = allocate_filled(new_cap, [&](pointer p) {
+                    std::ranges::uninitialized_copy_n(std::move(first), count,
+                                                      p + offset, std::unreachable_sentinel);
+                });
+                relocate_to(new_buf, offset, count);
+                m_sz += count;
+                return m_st + offset;
+            }
+        }
+
+        iterator pos = begin() + offset;
+        size_type tail = m_sz - offset;
+        if (count >= tail) {
+            std::uninitialized_move(pos, end(), pos + count);
+            auto rest = std::ranges::copy_n(std::move(first), tail, pos).in;
+            std::ranges::uninitialized_copy_n(std::move(rest), count - tail,
+                                              end(), std::unreachable_sentinel);
+        } else {
+            std::uninitialized_move(end() - count, end(), end());
+            std::move_backward(pos, end() - count, end());
+            std::ranges::copy_n(std::move(first), count, pos);
+        }
+        m_sz += count;
+        return pos;
+    }
+
+    // Gives an empty vector a buffer of exactly count elements, unless the
+    // inline one is big enough.
+    constexpr void allocate_exactly(size_type count) {
+        if (count > max_size()) {
+            throw std::length_error("Try to allocate space larger than max_size()");
+        } else if (count > m_cap) {
+            m_st = m_alloc.allocate(count);
+            m_cap = count;
+        }
+    }
+
+    // Grows the buffer to hold at least new_cap elements.
+    constexpr void grow_to(size_type new_cap) {
+        if (!try_reallocate(new_cap)) {
+            relocate_to(my::allocate_at_least(m_alloc, new_cap));
+        }
+    }
+
+    // Moves the elements into a smaller buffer of new_cap (>= size)
+    // elements, or back inline when they fit.
+    constexpr void shrink_to(size_type new_cap) {
+        if (new_cap <= Storage::capacity) {
+            relocate_to({m_storage.data(), Storage::capacity});
+        } else if (!try_reallocate(new_cap)) {
+            relocate_to({m_alloc.allocate(new_cap), new_cap});
+        }
+    }
+
+    // Resizes a heap buffer through allocator.reallocate, which keeps the
+    // bytes of the elements. Returns false if unsupported, if the elements
+    // are inline, or if the allocator failed.
+    constexpr bool try_reallocate(size_type new_cap) {
+        if constexpr (can_reallocate) {
+            if !consteval {
+                if (is_inline()) return false;
+                auto new_buf = m_alloc.reallocate(m_st, m_cap, new_cap);
+                if (new_buf.ptr != nullptr) {
+                    m_st = new_buf.ptr;
+                    m_cap = new_buf.count;
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    // Frees the current heap buffer and takes over the elements of other,
+    // whose heap buffer m_alloc must be able to free.
+    constexpr void take_storage(vector_base& other) noexcept {
+        std::destroy(begin(), end());
+        release();
+        m_st = m_storage.data();
+        m_cap = Storage::capacity;
+        m_sz = 0;
+        take_elements(other);
+    }
+
+    // Takes over the heap buffer of other, or relocates its inline elements
+    // into ours, which must be empty.
+    constexpr void take_elements(vector_base& other) noexcept {
+        if (other.is_inline()) {
+            my::uninitialized_relocate(other.begin(), other.end(), m_st);
+        } else {
+            m_st = my::exchange(other.m_st, other.m_storage.data());
+            m_cap = my::exchange(other.m_cap, Storage::capacity);
+        }
+        m_sz = my::exchange(other.m_sz, 0);
+    }
+
+    // A buffer for at least new_cap elements, with the new ones constructed
+    // in it by fill(ptr). If fill throws, the buffer is freed and the vector
+    // is left as it was.
+    template<class Fill>
+    constexpr allocation_result<pointer, size_type> allocate_filled(size_type new_cap, Fill fill) {
+        auto new_buf = my::allocate_at_least(m_alloc, new_cap);
+        try {
+            fill(new_buf.ptr);
+        } catch (...) {
+            m_alloc.deallocate(new_buf.ptr, new_buf.count);
+            throw;
+        }
+        return new_buf;
+    }
+
+    // Destroys the elements and takes over new_buf, which already holds
+    // new_sz constructed elements.
+    constexpr void replace_with(allocation_result<pointer, size_type> new_buf, size_type new_sz) {
+        std::destroy(begin(), end());
+        release();
+        m_st = new_buf.ptr;
+        m_cap = new_buf.count;
+        m_sz = new_sz;
+    }
+
+    // Relocates the elements into new_buf, leaving `gap` uninitialized slots
+    // at `offset`, then releases the old buffer.
+    constexpr void relocate_to(allocation_result<pointer, size_type> new_buf,
+                               size_type offset = 0, size_type gap = 0) {
+        my::uninitialized_relocate(begin(), begin() + offset, new_buf.ptr);
+        my::uninitialized_relocate(begin() + offset, end(), new_buf.ptr + offset + gap);
+        release();
+        m_st = new_buf.ptr;
+        m_cap = new_buf.count;
+    }
+
+    // Returns a heap buffer to the allocator; the inline one stays put.
+    constexpr void release() noexcept {
+        if (!is_inline()) {
+            m_alloc.deallocate(m_st, m_cap);
+        }
+    }
+}; // class vector_base
+
+template<class T, class Alloc, class Growth, class Storage, class U = T>
+constexpr typename vector_base<T, Alloc, Growth, Storage>::size_type
+    erase(vector_base<T, Alloc, Growth, Storage>& c, const U& value)
+{
+    return erase_if(c, [&value](const auto& elem) { return elem == value; });
+}
+
+// Compacts the kept elements in a single pass.
+template<class T, class Alloc, class Growth, class Storage, class Pred>
+constexpr typename vector_base<T, Alloc, Growth, Storage>::size_type
+    erase_if(vector_base<T, Alloc, Growth, Storage>& c, Pred pred)
+{
+    auto new_end = my::remove_if_runs(c.data(), c.data() + c.size(), pred);
+    auto count = static_cast<typename vector_base<T, Alloc, Growth, Storage>::size_type>(
+        c.data() + c.size() - new_end);
+    c.erase(new_end, c.cend());
+    return count;
+}
+
+template<class T, class Alloc, class Growth, class Storage>
+constexpr bool operator==(const vector_base<T, Alloc, Growth, Storage>& lhs,
+                          const vector_base<T, Alloc, Growth, Storage>& rhs) {
+    return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+
+template<class T, class Alloc, class Growth, class Storage>
+constexpr auto operator<=>(const vector_base<T, Alloc, Growth, Storage>& lhs,
+                           const vector_base<T, Alloc, Growth, Storage>& rhs) {
+    return std::lexicographical_compare_three_way(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+
+} // namespace my
@@ -6,8 +6,11 @@
 #include <cstring>
 #include <utility>
 #include <algorithm>
+#include <functional>
+#include <unordered_set>
 #include <catch2/catch_test_macros.hpp>
 #include "my/optional.hpp"
+#include "my/string_view.hpp"
 
 using my::optional;
 using std::string;
@@ -126,3 +129,24 @@ TEST_CASE("my::optional can be formatted & printed", "[my::optional]") {
     REQUIRE(std::format("{}", some_int) == std::format("Some({})", some_int.value()));
     REQUIRE(std::format("{}", some_vec) == std::format("Some({})", some_vec.value()));
 }
+
+TEST_CASE("my::optional and my::pair can be hashed", "[my::optional]") {
+    using Key = my::pair<my::string_view, int>;
+    std::hash<my::string_view> hash_view;
+
+    REQUIRE(std::hash<optional<my::string_view>>{}(optional<my::string_view>{"key"}) == hash_view("key"));
+    REQUIRE(std::hash<optional<int>>{}(optional<int>{}) == std::hash<optional<int>>{}(optional<int>{}));
+    REQUIRE(std::hash<my::pair<int, optional<int>>>{}({1, optional<int>{2}}) ==
+            std::hash<my::pair<int, optional<int>>>{}({1, optional<int>{2}}));
+    // the halves are not interchangeable
+    REQUIRE(std::hash<my::pair<my::string_view, my::string_view>>{}({"a", "b"}) !=
+            std::hash<my::pair<my::string_view, my::string_view>>{}({"b", "a"}));
+
+    std::unordered_set<Key> keys;
+    for (int i = 0; i < 100; ++i) {
+        keys.insert(Key{"id", i});
+        keys.insert(Key{"id", i % 10});
+    }
+    REQUIRE(keys.size() == 100);
+    STATIC_REQUIRE(!std::is_default_constructible_v<std::hash<optional<std::vector<int>>>>);
+}
@@ -0,0 +1,261 @@
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <catch2/catch_test_macros.hpp>
+#include "my/string.hpp"
+#include "my/tracking_allocator.hpp"
+#include "my/vector.hpp"
+
+using my::string;
+using std::size_t;
+
+namespace {
+
+struct string_test_tag {};
+using tracked_string = my::basic_string<char, std::char_traits<char>,
+                                        my::tracking_allocator<my::allocator<char>, string_test_tag>>;
+
+std::uint64_t allocations() {
+    return my::tracking_allocator<my::allocator<char>, string_test_tag>::stats().allocations;
+}
+
+std::string_view std_view(const string& s) {
+    return {s.data(), s.size()};
+}
+
+} // anonymous namespace
+
+TEST_CASE("my::string keeps short contents inline", "[my::string]") {
+    STATIC_REQUIRE(sizeof(string) == 3 * sizeof(void*));
+    STATIC_REQUIRE(string::inline_capacity >= 22 || sizeof(void*) < 8);
+    STATIC_REQUIRE(my::is_trivially_relocatable_v<string>);
+
+    auto before = allocations();
+    {
+        tracked_string empty;
+        REQUIRE(empty.empty());
+        REQUIRE(empty.c_str()[0] == '\0');
+        REQUIRE(empty.capacity() == tracked_string::inline_capacity);
+
+        tracked_string full(tracked_string::inline_capacity, 'x');
+        REQUIRE(full.size() == tracked_string::inline_capacity);
+        REQUIRE(full.c_str()[full.size()] == '\0');
+
+        tracked_string key{"user:1234567890:profile"};
+        REQUIRE(key.size() == 23);
+        tracked_string copy{full};
+        tracked_string moved{std::move(copy)};
+        REQUIRE(moved == full);
+        REQUIRE(copy.empty());
+        REQUIRE(allocations() == before + 1);
+    }
+
+    // one char past the inline buffer goes to the heap
+    tracked_string s(tracked_string::inline_capacity, 'a');
+    s.push_back('b');
+    REQUIRE(allocations() == before + 2);
+    REQUIRE(s.size() == tracked_string::inline_capacity + 1);
+    REQUIRE(s.capacity() >= s.size());
+    REQUIRE(s.back() == 'b');
+    REQUIRE(s.c_str()[s.size()] == '\0');
+
+    s.resize(4);
+    s.shrink_to_fit();
+    REQUIRE(s.capacity() == tracked_string::inline_capacity);
+    REQUIRE(s == "aaaa");
+}
+
+TEST_CASE("my::string grows like std::string", "[my::string]") {
+    std::mt19937 rng{23};
+    string mine;
+    std::string theirs;
+    for (int round = 0; round < 2000; ++round) {
+        switch (rng() % 8) {
+        case 0: {
+            char ch = static_cast<char>('a' + rng() % 26);
+            mine.push_back(ch);
+            theirs.push_back(ch);
+            break;
+        }
+        case 1: {
+            std::string piece(rng() % 40, static_cast<char>('A' + rng() % 26));
+            mine.append(piece.data(), piece.size());
+            theirs.append(piece);
+            break;
+        }
+        case 2: {
+            size_t at = rng() % (theirs.size() + 1);
+            size_t count = rng() % 10;
+            mine.insert(at, "<ins>");
+            theirs.insert(at, "<ins>");
+            mine.erase(at, count);
+            theirs.erase(at, count);
+            break;
+        }
+        case 3: {
+            size_t at = rng() % (theirs.size() + 1);
+            size_t count = rng() % 6;
+            size_t count2 = rng() % 6;
+            mine.replace(at, count, count2, '#');
+            theirs.replace(at, count, count2, '#');
+            break;
+        }
+        case 4: {
+            size_t count = rng() % 64;
+            mine.resize(count, '.');
+            theirs.resize(count, '.');
+            break;
+        }
+        case 5:
+            if (!theirs.empty()) {
+                mine.pop_back();
+                theirs.pop_back();
+            }
+            break;
+        case 6:
+            mine.shrink_to_fit();
+            break;
+        default: {
+            size_t at = rng() % (theirs.size() + 1);
+            mine.replace(at, 3, "replacement");
+            theirs.replace(at, 3, "replacement");
+            break;
+        }
+        }
+        REQUIRE(std_view(mine) == theirs);
+        REQUIRE(mine.c_str()[mine.size()] == '\0');
+        REQUIRE(mine.capacity() >= mine.size());
+    }
+}
+
+TEST_CASE("my::string appends and replaces from itself", "[my::string]") {
+    string s{"abcdef"};
+    s.append(s.data(), s.size());
+    REQUIRE(s == "abcdefabcdef");
+    s.append(s.data() + 2, 3);
+    REQUIRE(s == "abcdefabcdefcde");
+
+    // past the inline buffer, the source lives in the buffer being replaced
+    s += s;
+    s += s;
+    REQUIRE(s.size() == 60);
+    REQUIRE(s.substr(0, 15) == "abcdefabcdefcde");
+    REQUIRE(s.substr(45) == "abcdefabcdefcde");
+
+    string t{"0123456789"};
+    t.insert(2, t.data() + 5, 4);
+    REQUIRE(t == "01567823456789");
+    t.replace(0, 4, t.data() + 8, 6);
+    REQUIRE(t == "4567897823456789");
+    t.assign(t.data() + 10, 5);
+    REQUIRE(t == "45678");
+    t.insert(t.begin() + 1, '_');
+    t.erase(t.end() - 1);
+    REQUIRE(t == "4_567");
+}
+
+TEST_CASE("my::string::resize_and_overwrite writes through data()", "[my::string]") {
+    string s{"prefix:"};
+    s.resize_and_overwrite(64, [](char* p, size_t count) {
+        REQUIRE(std::memcmp(p, "prefix:", 7) == 0);
+        std::memset(p + 7, 'z', count - 7);
+        return size_t{40};
+    });
+    REQUIRE(s.size() == 40);
+    REQUIRE(s.capacity() >= 64);
+    REQUIRE(s.starts_with("prefix:zz"));
+    REQUIRE(s.c_str()[40] == '\0');
+
+    s.resize_and_overwrite(3, [](char*, size_t) { return 2; });
+    REQUIRE(s == "pr");
+}
+
+TEST_CASE("my::string converts to my::string_view", "[my::string]") {
+    string s{"key = value; other = 42"};
+    my::string_view view = s;
+    REQUIRE(view.data() == s.data());
+    REQUIRE(view.size() == s.size());
+
+    REQUIRE(s.find("value") == 6);
+    REQUIRE(s.find('=') == 4);
+    REQUIRE(s.rfind('=') == 19);
+    REQUIRE(s.find_first_of(";=") == 4);
+    REQUIRE(s.find_last_not_of("0123456789") == 20);
+    REQUIRE(s.contains("other"));
+    REQUIRE_FALSE(s.contains('#'));
+    REQUIRE(s.ends_with("42"));
+    REQUIRE(std::hash<string>{}(s) == std::hash<my::string_view>{}(view));
+
+    string from_view{my::string_view{"from a view"}};
+    REQUIRE(from_view == my::string_view{"from a view"});
+    from_view = my::string_view{"reassigned"};
+    REQUIRE(from_view.size() == 10);
+
+    std::ostringstream os;
+    os << from_view;
+    REQUIRE(os.str() == "reassigned");
+}
+
+TEST_CASE("my::string compares and concatenates", "[my::string]") {
+    string a{"apple"};
+    string b{"banana"};
+    REQUIRE(a < b);
+    REQUIRE(a == "apple");
+    REQUIRE("apple" == a);
+    REQUIRE(a != b);
+    REQUIRE(my::string_view{"banana"} == b);
+    REQUIRE((b <=> "banana") == std::strong_ordering::equal);
+    REQUIRE(a.compare("applf") < 0);
+
+    REQUIRE(a + b == "applebanana");
+    REQUIRE(a + "-" + b + '!' == "apple-banana!");
+    REQUIRE("[" + a + "]" == "[apple]");
+    string long_one = string(30, 'x') + a;
+    REQUIRE(long_one.size() == 35);
+    REQUIRE(long_one.ends_with("xapple"));
+
+    REQUIRE_THROWS_AS(a.at(5), std::out_of_range);
+    REQUIRE_THROWS_AS(a.substr(6), std::out_of_range);
+    REQUIRE(a.substr(5).empty());
+}
+
+TEST_CASE("my::string works as a vector element", "[my::string]") {
+    my::vector<string> words;
+    for (int i = 0; i < 100; ++i) {
+        words.push_back(string(static_cast<size_t>(i % 40), static_cast<char>('a' + i % 26)));
+    }
+    for (int i = 0; i < 100; ++i) {
+        REQUIRE(words[static_cast<size_t>(i)].size() == static_cast<size_t>(i % 40));
+    }
+
+    string x{"short"};
+    string y(50, 'y');
+    swap(x, y);
+    REQUIRE(x.size() == 50);
+    REQUIRE(y == "short");
+    x = y;
+    REQUIRE(x == "short");
+    y = string(60, 'z');
+    x = std::move(y);
+    REQUIRE(x.size() == 60);
+    REQUIRE(y.empty());
+}
+
+TEST_CASE("my::string works in constant evaluation", "[my::string]") {
+    STATIC_REQUIRE([] {
+        string s{"key"};
+        s += '=';
+        s.append(40, 'v');
+        string copy = s;
+        s.clear();
+        s.shrink_to_fit();
+        return copy.size() == 44 && copy.starts_with("key=v") && s.empty() && s.c_str()[0] == '\0';
+    }());
+    STATIC_REQUIRE(string{"apple"} + "-" + string(3, 'x') == "apple-xxx");
+    STATIC_REQUIRE(std::hash<string>{}(string{"atom"}) == std::hash<my::string_view>{}("atom"));
+}
@@ -0,0 +1,922 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <charconv>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <ranges>
+#include <set>
+#include <stdexcept>
+#include <unordered_map>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include "my/aho_corasick.hpp"
+#include "my/hash.hpp"
+#include "my/intern_table.hpp"
+#include "my/parse.hpp"
+#include "my/perfect_hash_map.hpp"
+#include "my/split.hpp"
+#include "my/string_searcher.hpp"
+#include "my/string_view.hpp"
+
+using my::string_view;
+using std::string;
+
+namespace {
+
+// Random text over a small alphabet, so that partial matches are common.
+string random_text(std::mt19937& rng, std::size_t len, std::string_view alphabet) {
+    std::uniform_int_distribution<std::size_t> pick(0, alphabet.size() - 1);
+    string s(len, '\0');
+    for (char& c : s) {
+        c = alphabet[pick(rng)];
+    }
+    return s;
+}
+
+// Every (pattern, offset) occurrence, found one pattern at a time.
+my::vector<my::pattern_match> brute_force_matches(const std::vector<string>& patterns,
+                                                  std::string_view text) {
+    my::vector<my::pattern_match> matches;
+    for (std::size_t id = 0; id < patterns.size(); ++id) {
+        if (patterns[id].empty()) continue;
+        for (auto pos = text.find(patterns[id]); pos != std::string_view::npos;
+             pos = text.find(patterns[id], pos + 1)) {
+            matches.push_back({id, pos});
+        }
+    }
+    return matches;
+}
+
+// Pieces of text between matches of is_delim, found one char at a time.
+template<class IsDelim>
+std::vector<string> naive_split(const string& text, std::size_t delim_size, IsDelim is_delim) {
+    std::vector<string> pieces;
+    if (text.empty()) return pieces;
+    std::size_t start = 0;
+    for (std::size_t i = 0; i + delim_size <= text.size();) {
+        if (is_delim(i)) {
+            pieces.push_back(text.substr(start, i - start));
+            i += delim_size;
+            start = i;
+        } else {
+            ++i;
+        }
+    }
+    pieces.push_back(text.substr(start));
+    return pieces;
+}
+
+template<class Range>
+std::vector<string> collect(Range&& pieces) {
+    std::vector<string> out;
+    for (string_view piece : pieces) {
+        out.emplace_back(piece.data(), piece.size());
+    }
+    return out;
+}
+
+void sort_matches(my::vector<my::pattern_match>& matches) {
+    std::sort(matches.begin(), matches.end(), [](const auto& a, const auto& b) {
+        return a.offset != b.offset ? a.offset < b.offset : a.pattern < b.pattern;
+    });
+}
+
+} // anonymous namespace
+
+TEST_CASE("my::string_view::find matches std::string_view", "[my::string_view]") {
+    auto alphabet = GENERATE(std::string_view{"ab"}, std::string_view{"abc"},
+                             std::string_view{"abcdefghijklmnopqrstuvwxyz"});
+    std::mt19937 rng{42};
+
+    SECTION("random haystacks and needles") {
+        for (int round = 0; round < 200; ++round) {
+            string hay = random_text(rng, rng() % 300, alphabet);
+            string needle = random_text(rng, 1 + rng() % 12, alphabet);
+            string_view my_hay{hay.data(), hay.size()};
+            std::string_view std_hay{hay};
+            for (std::size_t pos = 0; pos <= hay.size() + 1; pos += 1 + pos / 8) {
+                REQUIRE(my_hay.find(needle.c_str(), pos, needle.size()) ==
+                        std_hay.find(needle, pos));
+            }
+        }
+    }
+
+    SECTION("every kernel agrees") {
+        for (int round = 0; round < 200; ++round) {
+            string hay = random_text(rng, rng() % 300, alphabet);
+            string needle = random_text(rng, 2 + rng() % 6, alphabet);
+            auto expected = std::string_view{hay}.find(needle);
+            auto offset = [&](const char* p) {
+                return p ? static_cast<std::size_t>(p - hay.data()) : string_view::npos;
+            };
+            auto unlimited = [] { return static_cast<std::size_t>(-1); };
+            std::size_t budget = unlimited();
+            REQUIRE(offset(my::find_substring_scalar(hay.data(), hay.size(),
+                                                     needle.data(), needle.size(), budget)) == expected);
+#if defined(__x86_64__) || defined(__i386__)
+            if (needle.size() <= hay.size()) {
+                budget = unlimited();
+                REQUIRE(offset(my::find_substring_sse2(hay.data(), hay.size(),
+                                                       needle.data(), needle.size(), budget)) == expected);
+                if (__builtin_cpu_supports("avx2")) {
+                    budget = unlimited();
+                    REQUIRE(offset(my::find_substring_avx2(hay.data(), hay.size(),
+                                                           needle.data(), needle.size(), budget)) == expected);
+                }
+            }
+#endif
+        }
+    }
+
+    SECTION("needles taken from the haystack") {
+        for (int round = 0; round < 200; ++round) {
+            string hay = random_text(rng, 64 + rng() % 512, alphabet);
+            std::size_t len = 1 + rng() % 40;
+            std::size_t at = rng() % (hay.size() - len);
+            string needle = hay.substr(at, len);
+            string_view my_hay{hay.data(), hay.size()};
+            REQUIRE(my_hay.find(needle.c_str()) == std::string_view{hay}.find(needle));
+            REQUIRE(my_hay.find(needle.c_str()) <= at);
+        }
+    }
+}
+
+TEST_CASE("my::two_way_matcher matches std::string_view", "[my::string_view]") {
+    auto alphabet = GENERATE(std::string_view{"a"}, std::string_view{"ab"}, std::string_view{"abc"},
+                             std::string_view{"\x01\x80\xff"});
+    std::mt19937 rng{3};
+
+    for (int round = 0; round < 400; ++round) {
+        string hay = random_text(rng, rng() % 400, alphabet);
+        string needle;
+        switch (round % 3) {
+        case 0: // random, rarely found
+            needle = random_text(rng, 1 + rng() % 48, alphabet);
+            break;
+        case 1: // periodic, with the period broken near the end
+            needle = random_text(rng, 1 + rng() % 4, alphabet);
+            while (needle.size() < 40) {
+                needle += needle;
+            }
+            needle.back() = alphabet[rng() % alphabet.size()];
+            break;
+        default: // cut from the haystack
+            if (hay.empty()) continue;
+            std::size_t at = rng() % hay.size();
+            needle = hay.substr(at, 1 + rng() % 64);
+            break;
+        }
+        std::string_view std_hay{hay};
+        auto offset = [&](const char* p) {
+            return p ? static_cast<std::size_t>(p - hay.data()) : string_view::npos;
+        };
+        REQUIRE(offset(my::two_way_matcher<>{needle.data(), needle.size()}.find(
+                    hay.data(), hay.size())) == std_hay.find(needle));
+        REQUIRE(offset(my::two_way_matcher<true>{needle.data(), needle.size()}.find(
+                    hay.data(), hay.size())) == std_hay.rfind(needle));
+
+        string_view my_hay{hay.data(), hay.size()};
+        for (std::size_t pos = 0; pos <= hay.size() + 1; pos += 1 + pos / 4) {
+            REQUIRE(my_hay.find(needle.c_str(), pos, needle.size()) == std_hay.find(needle, pos));
+            REQUIRE(my_hay.rfind(needle.c_str(), pos, needle.size()) == std_hay.rfind(needle, pos));
+        }
+    }
+}
+
+TEST_CASE("my::find_substring falls back to Two-Way on adversarial input", "[my::string_view]") {
+    // every window matches the first and the last needle char
+    string needle = string(20, 'a') + "b" + string(20, 'a');
+    string hay(100000, 'a');
+    std::size_t budget = 1000;
+    const char* stop = my::find_substring_scalar(hay.data(), hay.size(), needle.data(),
+                                                 needle.size(), budget);
+    REQUIRE(budget == 0);
+    REQUIRE(stop == hay.data() + 1000 / needle.size());
+
+    string_view sv{hay.data(), hay.size()};
+    REQUIRE(sv.find(needle.c_str()) == string_view::npos);
+    hay.replace(hay.size() - 50, needle.size(), needle);
+    sv = string_view{hay.data(), hay.size()};
+    REQUIRE(sv.find(needle.c_str()) == hay.size() - 50);
+    REQUIRE(sv.find(needle.c_str(), hay.size() - 49) == string_view::npos);
+    REQUIRE(sv.rfind(needle.c_str()) == hay.size() - 50);
+    REQUIRE(sv.rfind(needle.c_str(), hay.size() - 51) == string_view::npos);
+}
+
+TEST_CASE("my::string_view::rfind matches std::string_view", "[my::string_view]") {
+    std::mt19937 rng{5};
+    for (int round = 0; round < 200; ++round) {
+        string hay = random_text(rng, rng() % 200, "abc");
+        string needle = random_text(rng, rng() % 6, "abc");
+        string_view my_hay{hay.data(), hay.size()};
+        std::string_view std_hay{hay};
+        REQUIRE(my_hay.rfind(needle.c_str(), string_view::npos, needle.size()) == std_hay.rfind(needle));
+        for (std::size_t pos = 0; pos <= hay.size() + 1; pos += 1 + pos / 4) {
+            REQUIRE(my_hay.rfind(needle.c_str(), pos, needle.size()) == std_hay.rfind(needle, pos));
+        }
+    }
+    STATIC_REQUIRE(string_view{"abcabc"}.rfind("bc") == 4);
+    STATIC_REQUIRE(string_view{"abcabc"}.rfind("bc", 3) == 1);
+}
+
+TEST_CASE("my::string_view::find handles the edges", "[my::string_view]") {
+    string hay(200, 'x');
+    hay += "needle";
+    string_view sv{hay.data(), hay.size()};
+
+    REQUIRE(sv.find("needle") == 200);
+    REQUIRE(sv.find("needles") == string_view::npos);
+    REQUIRE(sv.find("") == 0);
+    REQUIRE(sv.find("", hay.size()) == hay.size());
+    REQUIRE(sv.find("", hay.size() + 1) == string_view::npos);
+    REQUIRE(sv.find("x", 199) == 199);
+    REQUIRE(sv.find("xn") == 199);
+    REQUIRE(sv.find("le", 203) == 204);
+    REQUIRE(sv.find("le", 205) == string_view::npos);
+    REQUIRE(string_view{}.find("a") == string_view::npos);
+
+    // the match sits right at the end of every vector block size
+    for (std::size_t len = 3; len < 80; ++len) {
+        string text(len, 'a');
+        text[0] = 'b';
+        text[len - 1] = 'b';
+        string needle = "a" + string(1, 'b');
+        REQUIRE(string_view{text.data(), text.size()}.find(needle.c_str()) == len - 2);
+    }
+
+    // needle with embedded NULs
+    string bin{"ab\0cd\0ef", 8};
+    REQUIRE(string_view{bin.data(), bin.size()}.find("\0ef", 0, 3) == 5);
+}
+
+TEST_CASE("my::string_view::find works in constant evaluation", "[my::string_view]") {
+    constexpr string_view sv{"the quick brown fox"};
+    STATIC_REQUIRE(sv.find("quick") == 4);
+    STATIC_REQUIRE(sv.find("fox", 5) == 16);
+    STATIC_REQUIRE(sv.find("dog") == string_view::npos);
+}
+
+TEST_CASE("my::string_view::find_*_of match std::string_view", "[my::string_view]") {
+    // the last alphabet spans more high nibbles than the shuffle classifier handles
+    auto alphabet = GENERATE(std::string_view{"ab"}, std::string_view{"abcdefghijklmnopqrstuvwxyz"},
+                             std::string_view{" \t\n,;:\"'\x7f\x80\xc3\xff"},
+                             std::string_view{"\x01\x12#4E\x56g\x78\x89\x9a\xab\xbc\xcd\xde\xef\xf0"});
+    std::mt19937 rng{7};
+
+    for (int round = 0; round < 200; ++round) {
+        string hay = random_text(rng, rng() % 200, alphabet);
+        string set = random_text(rng, rng() % 6, alphabet);
+        string_view my_hay{hay.data(), hay.size()};
+        std::string_view std_hay{hay};
+        for (std::size_t pos = 0; pos <= hay.size() + 1; pos += 1 + pos / 4) {
+            REQUIRE(my_hay.find_first_of(set.c_str(), pos, set.size()) ==
+                    std_hay.find_first_of(set, pos));
+            REQUIRE(my_hay.find_first_not_of(set.c_str(), pos, set.size()) ==
+                    std_hay.find_first_not_of(set, pos));
+            REQUIRE(my_hay.find_last_of(set.c_str(), pos, set.size()) ==
+                    std_hay.find_last_of(set, pos));
+            REQUIRE(my_hay.find_last_not_of(set.c_str(), pos, set.size()) ==
+                    std_hay.find_last_not_of(set, pos));
+        }
+        REQUIRE(my_hay.find_last_of(set.c_str(), string_view::npos, set.size()) ==
+                std_hay.find_last_of(set));
+        REQUIRE(my_hay.find_last_not_of(set.c_str(), string_view::npos, set.size()) ==
+                std_hay.find_last_not_of(set));
+    }
+}
+
+TEST_CASE("my::byte_set kernels agree", "[my::string_view]") {
+    std::mt19937 rng{11};
+    std::uniform_int_distribution<int> byte(0, 255);
+
+    for (int round = 0; round < 300; ++round) {
+        string set(1 + rng() % 24, '\0');
+        for (char& c : set) {
+            c = static_cast<char>(byte(rng));
+        }
+        my::byte_set bytes{set.data(), set.size()};
+        REQUIRE(bytes.size() == std::set<char>(set.begin(), set.end()).size());
+
+        // mostly members, so that both searches have to look a while
+        string hay(rng() % 300, '\0');
+        for (char& c : hay) {
+            c = (rng() % 16 == 0) ? static_cast<char>(byte(rng)) : set[rng() % set.size()];
+        }
+        for (bool member : {true, false}) {
+            const char* first = my::find_in_set_scalar(hay.data(), hay.size(), bytes, member);
+            const char* last = my::rfind_in_set_scalar(hay.data(), hay.size(), bytes, member);
+            REQUIRE(my::find_in_set(hay.data(), hay.size(), bytes, member) == first);
+            REQUIRE(my::rfind_in_set(hay.data(), hay.size(), bytes, member) == last);
+#if defined(__x86_64__) || defined(__i386__)
+            if (__builtin_cpu_supports("ssse3")) {
+                REQUIRE(my::find_in_set_ssse3(hay.data(), hay.size(), bytes, member) == first);
+                REQUIRE(my::rfind_in_set_ssse3(hay.data(), hay.size(), bytes, member) == last);
+            }
+            if (__builtin_cpu_supports("avx2")) {
+                REQUIRE(my::find_in_set_avx2(hay.data(), hay.size(), bytes, member) == first);
+                REQUIRE(my::rfind_in_set_avx2(hay.data(), hay.size(), bytes, member) == last);
+            }
+#endif
+        }
+    }
+}
+
+TEST_CASE("my::string_view::find_*_of work in constant evaluation", "[my::string_view]") {
+    constexpr string_view sv{"key = value; other = 42"};
+    STATIC_REQUIRE(sv.find_first_of("=;") == 4);
+    STATIC_REQUIRE(sv.find_last_of("=;") == 19);
+    STATIC_REQUIRE(sv.find_first_not_of("key ") == 4);
+    STATIC_REQUIRE(sv.find_last_not_of("0123456789") == 20);
+    STATIC_REQUIRE(sv.find_first_of("xz") == string_view::npos);
+}
+
+TEST_CASE("my::string_searcher finds what std::string_view finds", "[my::string_view]") {
+    auto alphabet = GENERATE(std::string_view{"ab"}, std::string_view{"abcdefghijklmnopqrstuvwxyz"});
+    std::mt19937 rng{13};
+
+    for (int round = 0; round < 100; ++round) {
+        // short needles and long ones, which may switch to Two-Way
+        string needle = random_text(rng, (round % 2) ? 1 + rng() % 8 : 32 + rng() % 40, alphabet);
+        my::string_searcher searcher{string_view{needle.data(), needle.size()}};
+        REQUIRE(searcher.needle() == string_view{needle.data(), needle.size()});
+
+        for (int hay_round = 0; hay_round < 5; ++hay_round) {
+            string hay = random_text(rng, rng() % 500, alphabet);
+            if (hay.size() > needle.size() && rng() % 2) {
+                hay.replace(rng() % (hay.size() - needle.size()), needle.size(), needle);
+            }
+            string_view my_hay{hay.data(), hay.size()};
+            std::string_view std_hay{hay};
+            for (std::size_t pos = 0; pos <= hay.size() + 1; pos += 1 + pos / 4) {
+                REQUIRE(searcher.find(my_hay, pos) == std_hay.find(needle, pos));
+                REQUIRE(my_hay.find(searcher, pos) == std_hay.find(needle, pos));
+            }
+
+            my::vector<std::size_t> expected;
+            for (auto pos = std_hay.find(needle); pos != std::string_view::npos;
+                 pos = std_hay.find(needle, pos + 1)) {
+                expected.push_back(pos);
+            }
+            REQUIRE(searcher.find_all(my_hay) == expected);
+        }
+    }
+}
+
+TEST_CASE("my::string_searcher is a value type", "[my::string_view]") {
+    string hay = string(1000, 'a') + "needle" + string(1000, 'a') + "needle";
+    string_view sv{hay.data(), hay.size()};
+
+    my::string_searcher original{"needle"};
+    my::string_searcher copy{original};
+    REQUIRE(copy.find(sv) == 1000);
+
+    my::string_searcher moved{std::move(original)};
+    REQUIRE(moved.find(sv, 1001) == 2006);
+
+    // the long needle also checks that copies do not keep the old Two-Way state
+    string long_needle = string(40, 'a') + "needle";
+    my::string_searcher other{string_view{long_needle.data(), long_needle.size()}};
+    copy = other;
+    other = my::string_searcher{"none"};
+    REQUIRE(copy.find(sv) == 960);
+    REQUIRE(copy.find_all(sv) == my::vector<std::size_t>{960, 1966});
+    REQUIRE(other.find(sv) == string_view::npos);
+
+    my::string_searcher empty{""};
+    REQUIRE(empty.find(sv, 7) == 7);
+    REQUIRE(empty.find_all(string_view{"ab"}) == my::vector<std::size_t>{0, 1, 2});
+
+    my::basic_string_searcher<wchar_t> wide{my::basic_string_view<wchar_t>{L"bc"}};
+    REQUIRE(wide.find(my::basic_string_view<wchar_t>{L"abcbc"}) == 1);
+    REQUIRE(wide.find_all(my::basic_string_view<wchar_t>{L"abcbc"}) == my::vector<std::size_t>{1, 3});
+}
+
+TEST_CASE("my::aho_corasick reports every occurrence", "[my::string_view]") {
+    auto alphabet = GENERATE(std::string_view{"ab"}, std::string_view{"abcd"},
+                             std::string_view{"abcdefghijklmnopqrstuvwxyz"});
+    std::mt19937 rng{17};
+
+    for (int round = 0; round < 100; ++round) {
+        std::vector<string> patterns;
+        for (std::size_t k = 1 + rng() % 20; k > 0; --k) {
+            patterns.push_back(random_text(rng, rng() % 6, alphabet));
+        }
+        // a prefix and a duplicate of another pattern
+        patterns.push_back(patterns[0].substr(0, patterns[0].size() / 2));
+        patterns.push_back(patterns[0]);
+        my::aho_corasick automaton{patterns};
+        REQUIRE(automaton.pattern_count() == patterns.size());
+
+        string text = random_text(rng, rng() % 400, alphabet);
+        auto expected = brute_force_matches(patterns, text);
+        auto found = automaton.find_all(string_view{text.data(), text.size()});
+
+        // matches come ordered by their end
+        for (std::size_t i = 1; i < found.size(); ++i) {
+            REQUIRE(found[i - 1].offset + patterns[found[i - 1].pattern].size() <=
+                    found[i].offset + patterns[found[i].pattern].size());
+        }
+        sort_matches(found);
+        sort_matches(expected);
+        REQUIRE(found == expected);
+        REQUIRE(automaton.contains_any(string_view{text.data(), text.size()}) == !expected.empty());
+
+        // the same matches when the text arrives in chunks
+        my::vector<my::pattern_match> streamed;
+        my::aho_corasick::scanner scanner{automaton};
+        for (std::size_t at = 0; at < text.size();) {
+            std::size_t len = std::min<std::size_t>(rng() % 8, text.size() - at);
+            scanner.feed(string_view{text.data() + at, len},
+                         [&](my::pattern_match match) { streamed.push_back(match); });
+            at += len;
+        }
+        REQUIRE(scanner.position() == text.size());
+        sort_matches(streamed);
+        REQUIRE(streamed == expected);
+    }
+}
+
+TEST_CASE("my::aho_corasick handles any byte", "[my::string_view]") {
+    // every byte value occurs in some pattern, so there is no shared class
+    std::vector<string> patterns;
+    for (int byte = 0; byte < 256; byte += 2) {
+        patterns.push_back(string{static_cast<char>(byte), static_cast<char>(byte + 1)});
+    }
+    patterns.push_back(string{"\0\xff", 2});
+    patterns.push_back("");
+    my::aho_corasick automaton{patterns};
+
+    string text;
+    for (int byte = 255; byte >= 0; --byte) {
+        text += static_cast<char>(byte);
+        text += static_cast<char>(255 - byte);
+    }
+    auto expected = brute_force_matches(patterns, text);
+    auto found = automaton.find_all(string_view{text.data(), text.size()});
+    sort_matches(found);
+    sort_matches(expected);
+    REQUIRE(found == expected);
+
+    my::aho_corasick keywords{"ERROR", "timeout", "time"};
+    REQUIRE(keywords.find_all("12:00 ERROR upstream timeout") ==
+            my::vector<my::pattern_match>{{0, 6}, {2, 21}, {1, 21}});
+    REQUIRE_FALSE(keywords.contains_any("12:00 INFO ok"));
+    REQUIRE(my::aho_corasick{std::vector<string>{}}.find_all("abc").empty());
+}
+
+TEST_CASE("my::intern_table hands out one atom per string", "[my::string_view]") {
+    my::intern_table table{4};
+    my::atom user = table.intern("user");
+    string name = "user";
+    REQUIRE(table.intern(string_view{name.data(), name.size()}) == user);
+    REQUIRE(user.data() != name.data());
+    REQUIRE(user.view() == "user");
+    REQUIRE(user.c_str()[user.size()] == '\0');
+    REQUIRE(table.intern("users") != user);
+    REQUIRE(table.size() == 2);
+
+    // the empty string is the default atom in every table
+    REQUIRE(table.intern("") == my::atom{});
+    REQUIRE(my::atom{}.view().empty());
+    REQUIRE(table.size() == 2);
+
+    my::atom found;
+    REQUIRE(table.find("users", &found));
+    REQUIRE(found.view() == "users");
+    REQUIRE_FALSE(table.contains("use"));
+
+    // atoms and their chars survive the table growing
+    std::vector<my::atom> atoms;
+    for (int i = 0; i < 1000; ++i) {
+        string key = "field" + std::to_string(i);
+        atoms.push_back(table.intern(string_view{key.data(), key.size()}));
+    }
+    REQUIRE(table.size() == 1002);
+    REQUIRE(table.intern("user") == user);
+    for (int i = 0; i < 1000; ++i) {
+        string key = "field" + std::to_string(i);
+        REQUIRE(atoms[i].view() == string_view{key.data(), key.size()});
+        REQUIRE(atoms[i].hash() == table.intern(atoms[i]).hash());
+    }
+    std::unordered_set<my::atom> distinct(atoms.begin(), atoms.end());
+    REQUIRE(distinct.size() == atoms.size());
+}
+
+TEST_CASE("my::intern_table agrees across threads", "[my::string_view]") {
+    my::intern_table table;
+    constexpr int n_threads = 4;
+    constexpr int n_keys = 2000;
+    std::vector<std::vector<my::atom>> seen(n_threads);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < n_threads; ++t) {
+        threads.emplace_back([&, t] {
+            // each thread walks the keys from a different start
+            for (int i = 0; i < n_keys; ++i) {
+                string key = "tag" + std::to_string((i + t * 500) % n_keys);
+                seen[t].push_back(table.intern(string_view{key.data(), key.size()}));
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    REQUIRE(table.size() == n_keys);
+    for (int t = 1; t < n_threads; ++t) {
+        for (int i = 0; i < n_keys; ++i) {
+            REQUIRE(seen[t][i] == seen[0][(i + t * 500) % n_keys]);
+        }
+    }
+}
+
+TEST_CASE("my::hash_bytes kernels agree", "[my::string_view]") {
+    std::mt19937 rng{29};
+    // split, or \xff would swallow the letters after it
+    constexpr char alphabet[] = "\x00\x01\x7f\x80\xff" "abcdefgh";
+    string bytes = random_text(rng, 5000, std::string_view{alphabet, sizeof(alphabet) - 1});
+    for (std::size_t len = 0; len <= bytes.size(); len += 1 + len / 16) {
+        for (std::size_t offset : {std::size_t{0}, std::size_t{3}}) {
+            if (offset + len > bytes.size()) continue;
+            const char* p = bytes.data() + offset;
+            std::uint64_t expected = my::hash_bytes_with(my::accumulate_scalar, p, len, 42);
+#if defined(__x86_64__) || defined(__i386__)
+            REQUIRE(my::hash_bytes_with(my::accumulate_sse2, p, len, 42) == expected);
+            if (__builtin_cpu_supports("avx2")) {
+                REQUIRE(my::hash_bytes_with(my::accumulate_avx2, p, len, 42) == expected);
+            }
+#endif
+            REQUIRE(my::hash_bytes(p, len, 42) == expected);
+        }
+    }
+}
+
+TEST_CASE("std::hash<my::string_view> works in constant evaluation", "[my::string_view]") {
+    constexpr std::hash<string_view> hash;
+    constexpr std::size_t short_key = hash("user:42");
+    REQUIRE(short_key == hash(string_view{string{"user:42"}.c_str()}));
+
+    static constexpr char text[] =
+        "The striped accumulator only starts past 256 bytes, so this text is long enough to take "
+        "it: its stripes are keyed, added into eight lanes, and the last one is read from the end "
+        "of the input, overlapping the one before it. Every kernel must agree with this value.";
+    constexpr std::size_t long_key = hash(string_view{text, sizeof(text) - 1});
+    STATIC_REQUIRE(sizeof(text) - 1 > 256);
+    string copy{text, sizeof(text) - 1};
+    REQUIRE(long_key == hash(string_view{copy.data(), copy.size()}));
+    REQUIRE(my::hash_bytes(text, 0) != my::hash_bytes(text, 0, 1));
+}
+
+TEST_CASE("std::hash<my::string_view> spreads similar keys", "[my::string_view]") {
+    std::hash<string_view> hash;
+    std::unordered_map<std::uint64_t, string> seen;
+    auto add = [&](const string& key) {
+        auto [it, inserted] = seen.try_emplace(hash(string_view{key.data(), key.size()}), key);
+        // a collision is only allowed between equal keys
+        REQUIRE((inserted || it->second == key));
+    };
+    // sequential ids, every 1- and 2-byte key, runs of zeros of every length
+    for (int i = 0; i < 100000; ++i) {
+        add("key" + std::to_string(i));
+        add(std::to_string(i) + "_suffix_long_enough_to_cross_the_sixteen_byte_path");
+    }
+    for (int a = 0; a < 256; ++a) {
+        add(string(1, static_cast<char>(a)));
+        for (int b = 0; b < 256; ++b) {
+            add(string{static_cast<char>(a), static_cast<char>(b)});
+        }
+    }
+    for (std::size_t len = 0; len <= 3000; ++len) {
+        add(string(len, '\0'));
+    }
+
+    // the low bits fill buckets evenly
+    constexpr std::size_t buckets = 1024;
+    std::vector<std::size_t> load(buckets);
+    for (const auto& entry : seen) {
+        ++load[entry.first % buckets];
+    }
+    double expected = static_cast<double>(seen.size()) / buckets;
+    double chi_square = 0;
+    for (std::size_t count : load) {
+        chi_square += (count - expected) * (count - expected) / expected;
+    }
+    // 1023 degrees of freedom: mean 1023, standard deviation about 45
+    REQUIRE(chi_square < 1023 + 6 * 45);
+
+    // flipping any one input bit flips about half of the output bits
+    std::mt19937 rng{31};
+    for (std::size_t len : {1, 8, 15, 16, 17, 47, 48, 100, 256, 257, 1000, 2048}) {
+        string key = random_text(rng, len, "abcdefghijklmnopqrstuvwxyz0123456789");
+        std::uint64_t base = hash(string_view{key.data(), key.size()});
+        double flipped = 0;
+        for (std::size_t bit = 0; bit < len * 8; ++bit) {
+            key[bit / 8] ^= static_cast<char>(1 << (bit % 8));
+            flipped += std::popcount(base ^ hash(string_view{key.data(), key.size()}));
+            key[bit / 8] ^= static_cast<char>(1 << (bit % 8));
+        }
+        double mean = flipped / static_cast<double>(len * 8);
+        REQUIRE(mean > 28);
+        REQUIRE(mean < 36);
+    }
+}
+
+namespace {
+
+// "cmd000" to "cmd199", in static storage so that views of them are constants
+constexpr std::size_t n_commands = 200;
+constexpr auto command_names = [] {
+    std::array<std::array<char, 7>, n_commands> names{};
+    for (std::size_t i = 0; i < n_commands; ++i) {
+        names[i] = {'c', 'm', 'd', static_cast<char>('0' + i / 100),
+                    static_cast<char>('0' + i / 10 % 10), static_cast<char>('0' + i % 10), '\0'};
+    }
+    return names;
+}();
+
+constexpr auto commands = my::make_perfect_hash_map([] {
+    std::array<my::pair<string_view, std::size_t>, n_commands> entries{};
+    for (std::size_t i = 0; i < n_commands; ++i) {
+        entries[i] = {string_view{command_names[i].data(), 6}, i};
+    }
+    return entries;
+}());
+
+} // anonymous namespace
+
+TEST_CASE("my::perfect_hash_map finds every key", "[my::string_view]") {
+    STATIC_REQUIRE(commands.size() == n_commands);
+    STATIC_REQUIRE(commands.at("cmd042") == 42);
+    STATIC_REQUIRE(!commands.contains("cmd200"));
+
+    std::size_t i = 0;
+    for (const auto& [name, value] : commands) {
+        // in the order given
+        REQUIRE(value == i++);
+        string copy{name.data(), name.size()};
+        auto it = commands.find(string_view{copy.data(), copy.size()});
+        REQUIRE(it != commands.end());
+        REQUIRE(it->second == value);
+    }
+
+    for (string_view miss : {string_view{""}, string_view{"cmd"}, string_view{"cmd0000"},
+                             string_view{"CMD001"}, string_view{"cmd19"}, string_view{"dmc001"}}) {
+        REQUIRE(commands.find(miss) == commands.end());
+    }
+    REQUIRE_THROWS_AS(commands.at("cmd999"), std::out_of_range);
+
+    constexpr auto verbs = my::make_perfect_hash_map<int>({
+        {"GET", 1}, {"SET", 2}, {"", 3},
+    });
+    STATIC_REQUIRE(verbs.at("") == 3);
+    STATIC_REQUIRE(verbs.at("SET") == 2);
+    STATIC_REQUIRE(!verbs.contains("GE"));
+
+    constexpr auto single = my::make_perfect_hash_map<int>({{"only", 7}});
+    STATIC_REQUIRE(single.at("only") == 7);
+    STATIC_REQUIRE(!single.contains(""));
+
+    REQUIRE_THROWS_AS(my::make_perfect_hash_map<int>({{"a", 1}, {"b", 2}, {"a", 3}}),
+                      std::invalid_argument);
+}
+
+TEST_CASE("my::split matches a naive splitter", "[my::string_view]") {
+    using SplitView = decltype(my::split(string_view{}, ','));
+    STATIC_REQUIRE(std::ranges::forward_range<SplitView>);
+    STATIC_REQUIRE(std::ranges::view<SplitView>);
+    STATIC_REQUIRE(std::ranges::view<decltype(my::tokenize(string_view{}, my::any_of(" ")))>);
+
+    auto alphabet = GENERATE(std::string_view{"a,"}, std::string_view{"ab,;"}, std::string_view{"abc, \t"});
+    std::mt19937 rng{37};
+    for (int round = 0; round < 300; ++round) {
+        string text = random_text(rng, rng() % 80, alphabet);
+        string_view view{text.data(), text.size()};
+
+        REQUIRE(collect(my::split(view, ',')) ==
+                naive_split(text, 1, [&](std::size_t i) { return text[i] == ','; }));
+        REQUIRE(collect(my::split(view, ",,")) ==
+                naive_split(text, 2, [&](std::size_t i) { return text.compare(i, 2, ",,") == 0; }));
+        auto in_set = [&](std::size_t i) { return text[i] == ',' || text[i] == ' ' || text[i] == ';'; };
+        REQUIRE(collect(my::split(view, my::any_of(", ;"))) == naive_split(text, 1, in_set));
+
+        auto tokens = naive_split(text, 1, in_set);
+        std::erase(tokens, string{});
+        REQUIRE(collect(my::tokenize(view, my::any_of(", ;"))) == tokens);
+    }
+}
+
+TEST_CASE("my::split handles the edges", "[my::string_view]") {
+    REQUIRE(collect(my::split(string_view{""}, ',')).empty());
+    REQUIRE(collect(my::split(string_view{","}, ',')) == std::vector<string>{"", ""});
+    REQUIRE(collect(my::split(string_view{"a,,b,"}, ',')) == std::vector<string>{"a", "", "b", ""});
+    REQUIRE(collect(my::split(string_view{"key"}, "::")) == std::vector<string>{"key"});
+    REQUIRE(collect(my::split(string_view{"a::b:::c"}, "::")) == std::vector<string>{"a", "b", ":c"});
+    REQUIRE(collect(my::tokenize(string_view{"  "}, ' ')).empty());
+    REQUIRE(collect(my::tokenize(string_view{"\tGET  /index.html \r\n"}, my::any_of(" \t\r\n"))) ==
+            std::vector<string>{"GET", "/index.html"});
+
+    // pieces point into the text
+    string_view text{"x=1;y=2"};
+    auto pieces = my::split(text, ';');
+    REQUIRE((*pieces.begin()).data() == text.data());
+    REQUIRE(pieces.front() == "x=1");
+    REQUIRE(std::ranges::distance(pieces) == 2);
+
+    // composes with the standard views
+    auto sizes = my::split(string_view{"a,bb,,ccc"}, ',')
+               | std::views::filter([](string_view piece) { return !piece.empty(); })
+               | std::views::transform([](string_view piece) { return piece.size(); });
+    REQUIRE(std::vector<std::size_t>(sizes.begin(), sizes.end()) == std::vector<std::size_t>{1, 2, 3});
+
+    constexpr std::size_t words = std::ranges::distance(my::tokenize(string_view{" a bc  d "}, my::any_of(" ")));
+    STATIC_REQUIRE(words == 3);
+}
+
+TEST_CASE("my::split_quoted keeps quoted delimiters", "[my::string_view]") {
+    string_view row{R"(1,"Smith, John","said ""hi, there""",,x)"};
+    REQUIRE(collect(my::split_quoted(row, ',')) ==
+            std::vector<string>{"1", R"("Smith, John")", R"("said ""hi, there""")", "", "x"});
+    REQUIRE(collect(my::split(row, ',')).size() == 7);
+
+    REQUIRE(collect(my::split_quoted(string_view{"'a;b';c"}, ';', '\'')) == std::vector<string>{"'a;b'", "c"});
+    REQUIRE(collect(my::split_quoted(string_view{R"(a,"b,c)"}, ',')) == std::vector<string>{"a", R"("b,c)"});
+    REQUIRE(collect(my::split_quoted(string_view{R"("a" || "b || c")"}, " || ")) ==
+            std::vector<string>{R"("a")", R"("b || c")"});
+}
+
+namespace {
+
+// Whether my::parse_prefix and std::from_chars agree on text: the same
+// error, the same end, and the same value, to the bit for floats.
+template<class T>
+bool parses_like_from_chars(const string& text) {
+    T mine{};
+    T theirs{};
+    my::parse_result result = my::parse_prefix(string_view{text.data(), text.size()}, mine);
+    auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), theirs);
+    if (result.ec != ec || result.pos != static_cast<std::size_t>(ptr - text.data())) {
+        return false;
+    }
+    if constexpr (std::floating_point<T>) {
+        if (std::isnan(mine) || std::isnan(theirs)) {
+            return std::isnan(mine) && std::isnan(theirs) && std::signbit(mine) == std::signbit(theirs);
+        }
+        using Bits = std::conditional_t<sizeof(T) == 8, std::uint64_t, std::uint32_t>;
+        return std::bit_cast<Bits>(mine) == std::bit_cast<Bits>(theirs);
+    } else {
+        return mine == theirs;
+    }
+}
+
+bool parses_float_like_from_chars(const string& text) {
+    return parses_like_from_chars<float>(text) && parses_like_from_chars<double>(text);
+}
+
+// printf into a string
+template<class... Args>
+string formatted(const char* format, Args... args) {
+    string s(std::snprintf(nullptr, 0, format, args...), '\0');
+    std::snprintf(s.data(), s.size() + 1, format, args...);
+    return s;
+}
+
+} // anonymous namespace
+
+TEST_CASE("my::parse reads integers like std::from_chars", "[my::string_view]") {
+    auto agree = [](const string& text) {
+        CAPTURE(text);
+        return parses_like_from_chars<std::int8_t>(text) && parses_like_from_chars<std::uint8_t>(text) &&
+               parses_like_from_chars<short>(text) && parses_like_from_chars<int>(text) &&
+               parses_like_from_chars<unsigned>(text) && parses_like_from_chars<std::int64_t>(text) &&
+               parses_like_from_chars<std::uint64_t>(text);
+    };
+    for (const char* text : {"", "-", "0", "-0", "00012", "127", "128", "-128", "-129", "255", "256",
+                             "12345678", "123456789abcdef", "1234567890123456789", "9223372036854775807",
+                             "-9223372036854775808", "-9223372036854775809", "18446744073709551615",
+                             "18446744073709551616", "28446744073709551615", "99999999999999999999",
+                             "100000000000000000000", "0000000000000000000000001", "-000000000000000000000128",
+                             "+1", " 1", "12a", "--1", "1e3", "0x10"}) {
+        REQUIRE(agree(text));
+    }
+
+    std::mt19937_64 rng{41};
+    for (int round = 0; round < 20000; ++round) {
+        string text = std::to_string(rng() >> (rng() % 64));
+        if (rng() % 2) text.insert(0, "-");
+        if (rng() % 4 == 0) text.insert(0, string(rng() % 12, '0'));
+        if (rng() % 3 == 0) text += ".5";
+        REQUIRE(agree(text));
+    }
+}
+
+TEST_CASE("my::parse reads floats like std::from_chars", "[my::string_view]") {
+    for (const char* text : {"0", "-0", "0.0e0", "1", "0.1", "-2.5e-3", ".5", "5.", ".", "-.", "-", "",
+                             "1e", "1e+", "1E-5x", "1e+308", "+1", " 1", "0x1p3", "e5",
+                             "1.7976931348623157e308", "1.7976931348623158e308", "1.7976931348623159e308",
+                             "1e309", "4.9e-324", "2.4703282292062327e-324", "2.4703282292062328e-324",
+                             "2.2250738585072011e-308", "1e-400", "0e999999999999", "3.4028235e38",
+                             "3.4028236e38", "1e39", "7e-46", "1e-46", "1.17549435e-38",
+                             "9007199254740993", "9007199254740993.000000000000000000001",
+                             "9007199254740992.99999999999999999999", "123456789012345678901234567890e-10",
+                             "0.1000000000000000055511151231257827021181583404541015625",
+                             "inf", "-Infinity", "INFINITE", "infinit", "nan", "-nan(123)", "nan(", "NaN(ab_c)x"}) {
+        CAPTURE(text);
+        REQUIRE(parses_float_like_from_chars(text));
+    }
+
+    // digits past any halfway point, with the deciding digit far out
+    string long_one = "1." + string(900, '0') + "1";
+    REQUIRE(parses_float_like_from_chars(long_one));
+    REQUIRE(parses_float_like_from_chars("0." + string(400, '0') + "1e400"));
+
+    std::mt19937_64 rng{43};
+    for (int round = 0; round < 20000; ++round) {
+        auto d = std::bit_cast<double>(rng() & 0x7fefffffffffffffull);
+        // shortest-ish, full and overlong renderings of a double
+        string text = formatted("%.*g", static_cast<int>(rng() % 25) + 1, d);
+        CAPTURE(text);
+        REQUIRE(parses_float_like_from_chars(text));
+        text = formatted("%.40e", d);
+        REQUIRE(parses_float_like_from_chars(text));
+
+        // random digits with a random point and exponent
+        text.clear();
+        for (std::size_t n = rng() % 40 + 1; n > 0; --n) {
+            text += static_cast<char>('0' + rng() % 10);
+        }
+        text.insert(rng() % (text.size() + 1), ".");
+        if (text != ".") {
+            text += "e" + std::to_string(static_cast<int>(rng() % 800) - 400);
+        }
+        REQUIRE(parses_float_like_from_chars(text));
+    }
+
+    // The exact halfway point between two doubles, and just either side of
+    // it: only the big integer path can round these.
+    for (int round = 0; round < 2000; ++round) {
+        std::uint64_t bits = rng() & 0x7fefffffffffffffull;
+        if (round % 4 == 0) bits >>= 12;
+        double d = std::bit_cast<double>(bits);
+        long double half = d + (static_cast<long double>(std::nextafter(d, INFINITY)) - d) / 2;
+        string text = formatted("%.780Le", half);
+        CAPTURE(text);
+        REQUIRE(parses_like_from_chars<double>(text));
+        std::size_t e = text.find('e');
+        for (const char* last : {"1", "9"}) {
+            string nudged = text.substr(0, e) + last + text.substr(e);
+            REQUIRE(parses_like_from_chars<double>(nudged));
+        }
+    }
+}
+
+TEST_CASE("my::parse takes the whole text", "[my::string_view]") {
+    STATIC_REQUIRE(*my::parse<int>("-42") == -42);
+    STATIC_REQUIRE(*my::parse<std::uint64_t>("18446744073709551615") == 18446744073709551615ull);
+    STATIC_REQUIRE(*my::parse<double>("0.1") == 0.1);
+    STATIC_REQUIRE(*my::parse<double>("2.2250738585072011e-308") == 2.2250738585072011e-308);
+    STATIC_REQUIRE(*my::parse<float>("3.4028235e38") == 3.4028235e38f);
+    // halfway between 1 and the next double, and just past it
+    STATIC_REQUIRE(*my::parse<double>("1.00000000000000011102230246251565404236316680908203125") == 1.0);
+    STATIC_REQUIRE(*my::parse<double>("1.00000000000000011102230246251565404236316680908203126") ==
+                   1.0000000000000002);
+    STATIC_REQUIRE(!my::parse<std::int8_t>("128").has_value());
+    STATIC_REQUIRE(!my::parse<double>("1e400").has_value());
+
+    REQUIRE(*my::parse<unsigned>("4294967295") == 4294967295u);
+    REQUIRE(std::isinf(*my::parse<double>("-inf")));
+    REQUIRE(std::isnan(*my::parse<float>("nan")));
+
+    std::size_t error_pos = 99;
+    REQUIRE(!my::parse<int>("42 ", &error_pos).has_value());
+    REQUIRE(error_pos == 2);
+    REQUIRE(!my::parse<double>("1.5e3x", &error_pos).has_value());
+    REQUIRE(error_pos == 5);
+    REQUIRE(!my::parse<double>("1e", &error_pos).has_value());
+    REQUIRE(error_pos == 1);
+    REQUIRE(!my::parse<int>("x1", &error_pos).has_value());
+    REQUIRE(error_pos == 0);
+    REQUIRE(!my::parse<int>("", &error_pos).has_value());
+    REQUIRE(!my::parse<std::uint8_t>("-1").has_value());
+    REQUIRE(!my::parse<std::uint16_t>("65536", &error_pos).has_value());
+    REQUIRE(error_pos == 0);
+
+    // a prefix leaves the rest for the caller
+    string_view fields{"12,-3.5e2,x"};
+    int i = 0;
+    double d = 0;
+    my::parse_result result = my::parse_prefix(fields, i);
+    REQUIRE((result && result.pos == 2 && i == 12));
+    result = my::parse_prefix(fields.substr(3), d);
+    REQUIRE((result && result.pos == 6 && d == -350.0));
+    result = my::parse_prefix(fields.substr(10), i);
+    REQUIRE((!result && result.ec == std::errc::invalid_argument && i == 12));
+}
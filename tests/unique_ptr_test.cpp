@@ -1,10 +1,14 @@
 #include <string>
 #include <memory>
 #include <print>
+#include <thread>
 #include <type_traits>
 #include <utility>
+#include <vector>
 #include <catch2/catch_test_macros.hpp>
 #include "my/memory.hpp"
+#include "my/memory_resource.hpp"
+#include "my/pool_allocator.hpp"
 
 using T = std::string;
 using Deleter = my::default_delete<T>;
@@ -180,6 +184,18 @@ TEST_CASE("my::unique_ptr modifiers", "[my::unique_ptr]") {
         REQUIRE(*p1 == "second");
         REQUIRE(*p2 == "first");
     }
+    SECTION("swap exchanges stateful deleters") {
+        CountPtr p1{nullptr, CountingDeleter{1}};
+        CountPtr p2{nullptr, CountingDeleter{2}};
+
+        p1.swap(p2);
+        REQUIRE(p1.get_deleter().id == 2);
+        REQUIRE(p2.get_deleter().id == 1);
+
+        swap(p1, p2);
+        REQUIRE(p1.get_deleter().id == 1);
+        REQUIRE(p2.get_deleter().id == 2);
+    }
 }
 
 TEST_CASE("my::unique_ptr comparison operators", "[my::unique_ptr]") {
@@ -291,3 +307,54 @@ TEST_CASE("my::unique_ptr with custom deleter by value", "[my::unique_ptr]") {
         REQUIRE(CountingDeleter::delete_count == 1);
     }
 }
+
+TEST_CASE("my::allocate_unique returns blocks to the allocator", "[my::unique_ptr]") {
+    using PoolPtr = decltype(my::allocate_unique<T>(my::pool_allocator<T>{}));
+    static_assert(sizeof(PoolPtr) == sizeof(T*), "stateless deleter is optimized away");
+
+    SECTION("pooled objects are constructed and destroyed") {
+        auto p = my::allocate_unique<T>(my::pool_allocator<T>{}, "pooled");
+        REQUIRE(*p == "pooled");
+        p.reset();
+        REQUIRE(p == nullptr);
+    }
+    SECTION("freed blocks are reused") {
+        auto p1 = my::allocate_unique<T>(my::pool_allocator<char>{}, "first");
+        T* raw = p1.get();
+        p1.reset();
+        auto p2 = my::allocate_unique<T>(my::pool_allocator<char>{}, "second");
+        REQUIRE(p2.get() == raw);
+        REQUIRE(*p2 == "second");
+    }
+    SECTION("many live objects") {
+        std::vector<PoolPtr> ptrs;
+        for (int i = 0; i < 10000; ++i) {
+            ptrs.push_back(my::allocate_unique<T>(my::pool_allocator<T>{}, std::to_string(i)));
+        }
+        for (int i = 0; i < 10000; ++i) {
+            REQUIRE(*ptrs[i] == std::to_string(i));
+        }
+    }
+    SECTION("objects may be freed by another thread") {
+        std::vector<PoolPtr> ptrs;
+        std::thread producer{[&ptrs] {
+            for (int i = 0; i < 1000; ++i) {
+                ptrs.push_back(my::allocate_unique<T>(my::pool_allocator<T>{}, std::to_string(i)));
+            }
+        }};
+        producer.join();
+        for (int i = 0; i < 1000; ++i) {
+            REQUIRE(*ptrs[i] == std::to_string(i));
+        }
+        ptrs.clear();
+        auto p = my::allocate_unique<T>(my::pool_allocator<T>{}, "after");
+        REQUIRE(*p == "after");
+    }
+    SECTION("stateful allocators are kept in the deleter") {
+        my::monotonic_arena arena{};
+        auto p = my::allocate_unique<T>(my::arena_allocator<T>{arena}, "arena");
+        static_assert(sizeof(p) > sizeof(T*));
+        REQUIRE(*p == "arena");
+        REQUIRE(p.get_deleter().get_allocator().arena() == &arena);
+    }
+}
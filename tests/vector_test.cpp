@@ -1,15 +1,28 @@
 #include <algorithm>
+#include <bit>
 #include <cstddef>
 #include <functional>
+#include <limits>
 #include <string>
 #include <vector>
 #include <list>
 #include <ranges>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <iterator>
 #include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_template_test_macros.hpp>
 #include <catch2/generators/catch_generators.hpp>
 #include <catch2/generators/catch_generators_adapters.hpp>
 #include <catch2/generators/catch_generators_random.hpp>
 #include "my/vector.hpp"
+#include "my/small_vector.hpp"
+#include "my/realloc_allocator.hpp"
+#include "my/mmap_allocator.hpp"
+#include "my/memory_resource.hpp"
+#include "my/thread_cache.hpp"
+#include "my/tracking_allocator.hpp"
 
 using my::vector;
 using std::list;
@@ -18,7 +31,18 @@ using VecStr = vector<string>;
 using VecInt = vector<int>;
 namespace stdr = std::ranges;
 
-TEST_CASE("my::vector can be constructed", "[my::vector]") {
+// The shared test cases run against every vector-like container.
+struct VectorFamily {
+    template<class T> using type = vector<T>;
+};
+
+struct SmallVectorFamily {
+    template<class T> using type = my::small_vector<T, 8>;
+};
+
+TEMPLATE_TEST_CASE("my::vector can be constructed", "[my::vector]", VectorFamily, SmallVectorFamily) {
+    using VecStr = typename TestType::template type<string>;
+    using VecInt = typename TestType::template type<int>;
 
     constexpr size_t n = 1024;
     auto i = GENERATE(take(100, random(size_t(0), n - 1)));
@@ -77,7 +101,9 @@ TEST_CASE("my::vector can be constructed", "[my::vector]") {
     }
 }
 
-TEST_CASE("my::vector can be inserted", "[my::vector]") {
+TEMPLATE_TEST_CASE("my::vector can be inserted", "[my::vector]", VectorFamily, SmallVectorFamily) {
+    using VecStr = typename TestType::template type<string>;
+    using VecInt = typename TestType::template type<int>;
 
     constexpr size_t n = 1024;
     VecStr empty{};
@@ -222,3 +248,758 @@ TEST_CASE("my::vector can be inserted", "[my::vector]") {
     }
 }
 
+
+TEMPLATE_TEST_CASE("my::vector relocates trivially relocatable elements", "[my::vector]",
+                   VectorFamily, SmallVectorFamily) {
+    using PairID = my::pair<int, double>;
+    using UPtr = my::unique_ptr<int>;
+    using VecStr = typename TestType::template type<string>;
+    static_assert(my::is_trivially_relocatable_v<PairID>);
+    static_assert(my::is_trivially_relocatable_v<UPtr>);
+    static_assert(my::is_trivially_relocatable_v<my::pair<int, UPtr>>);
+    static_assert(!my::is_trivially_relocatable_v<my::pair<int, string>>);
+
+    constexpr size_t n = 1024;
+
+    SECTION("pairs survive growth") {
+        typename TestType::template type<PairID> vp{};
+        for (size_t i = 0; i < n; ++i) {
+            vp.emplace_back(static_cast<int>(i), 0.5 * static_cast<double>(i));
+        }
+        vp.insert(vp.begin(), PairID{-1, -1.0});
+        vp.shrink_to_fit();
+        REQUIRE(vp.size() == n + 1);
+        REQUIRE(vp.front().first == -1);
+        REQUIRE(vp.back().first == static_cast<int>(n - 1));
+        REQUIRE(vp[n / 2 + 1].second == 0.5 * static_cast<double>(n / 2));
+    }
+
+    SECTION("unique_ptrs keep ownership across growth") {
+        typename TestType::template type<UPtr> vu{};
+        for (size_t i = 0; i < n; ++i) {
+            vu.push_back(my::make_unique<int>(static_cast<int>(i)));
+        }
+        vu.reserve(4 * n);
+        REQUIRE(vu.size() == n);
+        for (size_t i = 0; i < n; ++i) {
+            REQUIRE(*vu[i] == static_cast<int>(i));
+        }
+    }
+
+    SECTION("emplace_back may alias an element") {
+        VecStr vs(1, "foo");
+        vs.shrink_to_fit();
+        vs.emplace_back(vs[0]);
+        REQUIRE(vs.size() == 2);
+        REQUIRE(vs[1] == "foo");
+    }
+}
+
+TEMPLATE_TEST_CASE("my::vector supports bulk range operations", "[my::vector]",
+                   VectorFamily, SmallVectorFamily) {
+    using VecStr = typename TestType::template type<string>;
+    using VecInt = typename TestType::template type<int>;
+
+    constexpr size_t n = 1024;
+    VecInt vi{};
+    std::vector<int> std_vi{};
+    for (size_t i = 0; i < n; ++i) {
+        vi.push_back(static_cast<int>(i));
+        std_vi.push_back(static_cast<int>(i));
+    }
+
+    auto offset = GENERATE(take(5, random(size_t(0), n)));
+    auto count = GENERATE(take(5, random(size_t(0), n)));
+
+    SECTION("insert_range and append_range") {
+        std::vector<int> src(count, -1);
+        vi.insert_range(vi.begin() + offset, src);
+        std_vi.insert(std_vi.begin() + offset, src.begin(), src.end());
+        REQUIRE(stdr::equal(vi, std_vi));
+
+        vi.append_range(std::views::iota(0, static_cast<int>(count)));
+        for (int i = 0; i < static_cast<int>(count); ++i) std_vi.push_back(i);
+        REQUIRE(stdr::equal(vi, std_vi));
+    }
+
+    SECTION("input-only ranges are inserted in one pass") {
+        std::ostringstream out;
+        for (size_t i = 0; i < count; ++i) out << i << ' ';
+        std::istringstream in{out.str()};
+        auto it = vi.insert(vi.begin() + offset, std::istream_iterator<int>{in},
+                            std::istream_iterator<int>{});
+        for (size_t i = 0; i < count; ++i) {
+            std_vi.insert(std_vi.begin() + offset + i, static_cast<int>(i));
+        }
+        REQUIRE(it == vi.begin() + offset);
+        REQUIRE(stdr::equal(vi, std_vi));
+    }
+
+    SECTION("assign") {
+        VecStr vs(n / 2, "foo");
+        vs.assign(count, "bar");
+        REQUIRE(vs.size() == count);
+        REQUIRE(stdr::all_of(vs, [](const string& s) { return s == "bar"; }));
+
+        vs.assign({"a", "b", "c"});
+        REQUIRE(stdr::equal(vs, std::vector<string>{"a", "b", "c"}));
+
+        std::vector<string> src(count, "baz");
+        vs.assign_range(src);
+        REQUIRE(stdr::equal(vs, src));
+
+        vs.assign(vs.size() + n, vs.empty() ? string("x") : vs[0]);
+        REQUIRE(vs.size() == count + n);
+        REQUIRE(vs.back() == (count == 0 ? "x" : "baz"));
+    }
+
+    SECTION("erase") {
+        auto last = std::min(n, offset + count);
+        auto it = vi.erase(vi.begin() + offset, vi.begin() + last);
+        std_vi.erase(std_vi.begin() + offset, std_vi.begin() + last);
+        REQUIRE(it == vi.begin() + offset);
+        REQUIRE(stdr::equal(vi, std_vi));
+
+        if (!vi.empty()) {
+            vi.erase(vi.begin());
+            std_vi.erase(std_vi.begin());
+            REQUIRE(stdr::equal(vi, std_vi));
+        }
+
+        VecStr vs(n, "foo");
+        vs.erase(vs.begin() + offset / 2, vs.begin() + offset);
+        REQUIRE(vs.size() == n - (offset - offset / 2));
+    }
+
+    SECTION("erase and erase_if") {
+        auto is_odd = [](int x) { return x % 2 != 0; };
+        REQUIRE(my::erase_if(vi, is_odd) == std::erase_if(std_vi, is_odd));
+        REQUIRE(stdr::equal(vi, std_vi));
+        REQUIRE(my::erase(vi, 0) == 1);
+
+        VecStr vs{"a", "b", "a", "c"};
+        REQUIRE(my::erase(vs, string("a")) == 2);
+        REQUIRE(stdr::equal(vs, std::vector<string>{"b", "c"}));
+    }
+
+    SECTION("resize") {
+        vi.resize(count);
+        std_vi.resize(count);
+        REQUIRE(stdr::equal(vi, std_vi));
+
+        vi.resize(count + n);
+        std_vi.resize(count + n);
+        REQUIRE(stdr::equal(vi, std_vi));
+
+        vi.resize(2 * n + count, 7);
+        std_vi.resize(2 * n + count, 7);
+        REQUIRE(stdr::equal(vi, std_vi));
+
+        VecStr vs(1, "foo");
+        vs.shrink_to_fit();
+        vs.resize(n, vs[0]);
+        REQUIRE(vs.back() == "foo");
+    }
+
+    SECTION("resize_for_overwrite and resize_and_overwrite") {
+        vi.resize_for_overwrite(n + count);
+        REQUIRE(vi.size() == n + count);
+        REQUIRE(stdr::equal(vi | std::views::take(n), std_vi));
+
+        vi.resize_and_overwrite(count, [](int* p, size_t sz) {
+            for (size_t i = 0; i < sz; ++i) p[i] = -static_cast<int>(i);
+            return sz / 2;
+        });
+        REQUIRE(vi.size() == count / 2);
+        for (size_t i = 0; i < vi.size(); ++i) {
+            REQUIRE(vi[i] == -static_cast<int>(i));
+        }
+
+        VecStr vs{};
+        vs.resize_and_overwrite(count, [](string* p, size_t sz) {
+            for (size_t i = 0; i < sz; ++i) p[i] = "bar";
+            return sz;
+        });
+        REQUIRE(vs.size() == count);
+        REQUIRE(stdr::all_of(vs, [](const string& s) { return s == "bar"; }));
+    }
+}
+
+TEST_CASE("my::vector keeps the slack of allocate_at_least", "[my::vector]") {
+    my::allocator<char> alloc{};
+    auto [p, count] = alloc.allocate_at_least(1);
+    REQUIRE(p != nullptr);
+    REQUIRE(count >= 1);
+    alloc.deallocate(p, count);
+
+    SECTION("emplace_back records the real capacity") {
+        vector<char> vc{};
+        vc.push_back('a');
+        REQUIRE(vc.capacity() == count);
+        const char* init_pos = vc.data();
+        while (vc.size() < count) {
+            vc.push_back('b');
+        }
+        REQUIRE(vc.data() == init_pos);
+    }
+
+    SECTION("reserve never gives less than requested") {
+        constexpr size_t n = 1000;
+        VecStr vs{};
+        vs.reserve(n);
+        REQUIRE(vs.capacity() >= n);
+        vs.insert(vs.end(), vs.capacity(), "foo");
+        REQUIRE(vs.size() >= n);
+    }
+}
+
+TEST_CASE("my::vector grows in place with a reallocating allocator", "[my::vector]") {
+    using ReallocVec = vector<size_t, my::realloc_allocator<size_t>>;
+    static_assert(my::reallocating_allocator<my::realloc_allocator<size_t>>);
+    static_assert(!my::reallocating_allocator<my::allocator<size_t>>);
+
+    // large enough to cross into mapped blocks
+    constexpr size_t n = 1 << 18;
+    ReallocVec v{};
+    for (size_t i = 0; i < n; ++i) {
+        v.push_back(i);
+    }
+    REQUIRE(v.size() == n);
+    REQUIRE(v.capacity() >= n);
+    REQUIRE(v[n / 3] == n / 3);
+
+    SECTION("reserve and shrink_to_fit keep the elements") {
+        v.reserve(4 * n);
+        REQUIRE(v.capacity() >= 4 * n);
+        v.shrink_to_fit();
+        REQUIRE(v.capacity() >= n);
+        REQUIRE(v.back() == n - 1);
+    }
+
+    SECTION("insert may alias an element") {
+        v.shrink_to_fit();
+        v.reserve(v.size());
+        while (v.size() < v.capacity()) {
+            v.push_back(0);
+        }
+        size_t sz = v.size();
+        v.insert(v.begin(), v[1]);
+        v.insert(v.begin() + 1, 3, v[2]);
+        v.emplace_back(v[5]);
+        REQUIRE(v.size() == sz + 5);
+        REQUIRE(v[0] == 1);
+        REQUIRE(v[3] == 1);
+        REQUIRE(v[4] == 0);
+        REQUIRE(v[5] == 1);
+        REQUIRE(v.back() == 1);
+    }
+
+    SECTION("unique_ptr handles follow the buffer") {
+        vector<my::unique_ptr<int>, my::realloc_allocator<my::unique_ptr<int>>> vu{};
+        for (int i = 0; i < 1024; ++i) {
+            vu.push_back(my::make_unique<int>(i));
+        }
+        REQUIRE(*vu[1000] == 1000);
+    }
+}
+
+TEST_CASE("my::vector maps large buffers with mmap_allocator", "[my::vector]") {
+    // a low threshold keeps the mapped blocks small
+    using Alloc = my::mmap_allocator<size_t, size_t{1} << 16>;
+    using MmapVec = vector<size_t, Alloc>;
+    static_assert(std::same_as<std::allocator_traits<Alloc>::rebind_alloc<int>,
+                               my::mmap_allocator<int, size_t{1} << 16>>);
+    static_assert(my::reallocating_allocator<Alloc>);
+
+    constexpr size_t n = 1 << 18;
+    MmapVec v{};
+    for (size_t i = 0; i < n; ++i) {
+        v.push_back(i);
+    }
+    REQUIRE(v.size() == n);
+    REQUIRE(v[n / 3] == n / 3);
+    REQUIRE(v.back() == n - 1);
+
+    SECTION("mapped blocks start on a huge page") {
+        MmapVec w{};
+        w.reserve(n);
+        REQUIRE(reinterpret_cast<std::uintptr_t>(w.data()) % Alloc::huge_page_size == 0);
+        REQUIRE(w.capacity() * sizeof(size_t) % Alloc::huge_page_size == 0);
+    }
+
+    SECTION("shrinking back below the threshold") {
+        v.resize(16);
+        v.shrink_to_fit();
+        REQUIRE(v.capacity() * sizeof(size_t) < Alloc::mmap_threshold);
+        REQUIRE(v.back() == 15);
+    }
+
+    SECTION("populated mappings") {
+        vector<char, my::mmap_allocator<char, size_t{1} << 16, true>> vc(n, 'x');
+        REQUIRE(vc[n - 1] == 'x');
+    }
+}
+
+// Stateful allocator that propagates on copy assignment and swap.
+template<class T>
+struct tagged_allocator {
+    using value_type                             = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap            = std::true_type;
+
+    int tag = 0;
+
+    tagged_allocator(int t = 0) : tag{t} {}
+    template<class U>
+    tagged_allocator(const tagged_allocator<U>& other) : tag{other.tag} {}
+
+    T* allocate(size_t n) { return std::allocator<T>{}.allocate(n); }
+    void deallocate(T* p, size_t n) { std::allocator<T>{}.deallocate(p, n); }
+
+    // copies start out with a fresh tag
+    tagged_allocator select_on_container_copy_construction() const { return {-1}; }
+
+    bool operator==(const tagged_allocator&) const = default;
+};
+
+struct TaggedVectorFamily {
+    template<class T> using type = vector<T, tagged_allocator<T>>;
+    template<class T> using arena = vector<T, my::arena_allocator<T>>;
+};
+
+struct TaggedSmallVectorFamily {
+    template<class T> using type = my::small_vector<T, 4, tagged_allocator<T>>;
+    template<class T> using arena = my::small_vector<T, 4, my::arena_allocator<T>>;
+};
+
+TEMPLATE_TEST_CASE("my::vector honours allocator propagation", "[my::vector]",
+                   TaggedVectorFamily, TaggedSmallVectorFamily) {
+    using TaggedVec = typename TestType::template type<string>;
+    using ArenaVec = typename TestType::template arena<string>;
+    using ArenaVecVec = typename TestType::template arena<ArenaVec>;
+
+    constexpr size_t n = 64;
+    TaggedVec a(n, "foo", tagged_allocator<string>{1});
+    TaggedVec b(2, "bar", tagged_allocator<string>{2});
+
+    SECTION("copy construction asks the allocator") {
+        TaggedVec c{a};
+        REQUIRE(c.get_allocator().tag == -1);
+        REQUIRE(stdr::equal(c, a));
+
+        TaggedVec d{a, tagged_allocator<string>{3}};
+        REQUIRE(d.get_allocator().tag == 3);
+    }
+
+    SECTION("assignment and swap propagate") {
+        b = a;
+        REQUIRE(b.get_allocator().tag == 1);
+        REQUIRE(stdr::equal(b, a));
+
+        TaggedVec c(1, "baz", tagged_allocator<string>{3});
+        c = std::move(b);
+        REQUIRE(c.get_allocator().tag == 1);
+        REQUIRE(c.size() == n);
+
+        TaggedVec d(3, "qux", tagged_allocator<string>{4});
+        swap(c, d);
+        REQUIRE(c.get_allocator().tag == 4);
+        REQUIRE(d.get_allocator().tag == 1);
+        REQUIRE(c.size() == 3);
+        REQUIRE(d.size() == n);
+    }
+
+    SECTION("arena containers stay in their arena") {
+        my::monotonic_arena arena1{}, arena2{};
+        ArenaVec x(n, "foo", arena1);
+        ArenaVec y(n / 2, "bar", arena2);
+        for (size_t i = 0; i < n; ++i) {
+            x.push_back("baz");
+        }
+        REQUIRE(arena1.footprint() >= 2 * n * sizeof(string));
+
+        y = x;
+        REQUIRE(y.get_allocator().arena() == &arena2);
+        REQUIRE(stdr::equal(x, y));
+
+        x = std::move(y);
+        REQUIRE(x.get_allocator().arena() == &arena1);
+        REQUIRE(x.size() == 2 * n);
+
+        ArenaVec z{std::move(x), arena1};
+        REQUIRE(z.size() == 2 * n);
+        REQUIRE(z.get_allocator() == x.get_allocator());
+    }
+
+    SECTION("a graph of arena vectors") {
+        my::monotonic_arena arena{256};
+        ArenaVecVec graph(arena);
+        for (size_t i = 0; i < n; ++i) {
+            graph.emplace_back(i, string(32, 'x'), arena);
+        }
+        REQUIRE(graph.size() == n);
+        REQUIRE(graph.back().size() == n - 1);
+        REQUIRE(graph[1].get_allocator().arena() == &arena);
+    }
+}
+
+TEST_CASE("my::vector churns through the thread-caching backend", "[my::vector]") {
+    using CachedVec = vector<size_t, my::thread_cached_allocator<size_t>>;
+    using CachedStrVec = vector<string, my::thread_cached_allocator<string>>;
+    static_assert(std::same_as<std::allocator_traits<my::thread_cached_allocator<int>>::rebind_alloc<char>,
+                               my::thread_cached_allocator<char>>);
+    REQUIRE(my::thread_cache_backend::good_size(17) == 32);
+    REQUIRE(my::thread_cache_backend::good_size(300) == 512);
+
+    constexpr size_t n_threads = 4;
+    constexpr size_t rounds = 200;
+
+    SECTION("each thread allocates and frees its own vectors") {
+        std::vector<std::thread> threads;
+        std::vector<int> ok(n_threads, 1);
+        for (size_t t = 0; t < n_threads; ++t) {
+            threads.emplace_back([&ok, t] {
+                for (size_t r = 0; r < rounds; ++r) {
+                    CachedVec v{};
+                    for (size_t i = 0; i < r * 8; ++i) {
+                        v.push_back(i ^ t);
+                    }
+                    CachedStrVec vs(r % 16, string(40, 'x'));
+                    for (size_t i = 0; i < v.size(); ++i) {
+                        if (v[i] != (i ^ t)) ok[t] = 0;
+                    }
+                }
+            });
+        }
+        for (auto& th : threads) th.join();
+        REQUIRE(stdr::all_of(ok, [](int x) { return x == 1; }));
+    }
+
+    SECTION("blocks may be freed by another thread") {
+        std::vector<CachedVec> made(rounds);
+        std::thread producer{[&made] {
+            for (size_t r = 0; r < rounds; ++r) {
+                made[r].assign(r + 1, r);
+            }
+        }};
+        producer.join();
+        std::thread consumer{[&made] { made.clear(); }};
+        consumer.join();
+
+        CachedVec v(rounds, 7);
+        REQUIRE(v.back() == 7);
+    }
+}
+
+TEST_CASE("my::vector reports its memory use", "[my::vector]") {
+    struct test_tag {};
+    using Tracked = my::tracking_allocator<my::allocator<size_t>, test_tag>;
+    using TrackedVec = vector<size_t, Tracked>;
+    static_assert(std::same_as<std::allocator_traits<Tracked>::rebind_alloc<char>,
+                               my::tracking_allocator<my::allocator<char>, test_tag>>);
+    static_assert(my::reallocating_allocator<
+                  my::tracking_allocator<my::realloc_allocator<size_t>, test_tag>>);
+
+    SECTION("memory_usage splits live bytes and slack") {
+        VecInt v{};
+        v.reserve(100);
+        v.push_back(1);
+        auto usage = v.memory_usage();
+        REQUIRE(usage.live_bytes == sizeof(int));
+        REQUIRE(usage.slack_bytes == (v.capacity() - 1) * sizeof(int));
+
+        my::small_vector<int, 8> sv{1, 2};
+        REQUIRE(sv.memory_usage().live_bytes == 2 * sizeof(int));
+        REQUIRE(sv.memory_usage().slack_bytes == 6 * sizeof(int));
+    }
+
+    SECTION("tracking_allocator counts blocks and bytes") {
+        auto before = Tracked::stats();
+        {
+            TrackedVec v{};
+            for (size_t i = 0; i < 1000; ++i) {
+                v.push_back(i);
+            }
+            auto during = Tracked::stats();
+            REQUIRE(during.live_bytes - before.live_bytes ==
+                    static_cast<std::int64_t>(v.capacity() * sizeof(size_t)));
+            REQUIRE(during.allocations > before.allocations);
+            REQUIRE(during.peak_bytes >= v.capacity() * sizeof(size_t));
+        }
+        auto after = Tracked::stats();
+        REQUIRE(after.live_bytes == before.live_bytes);
+        REQUIRE(after.allocations - before.allocations ==
+                after.deallocations - before.deallocations);
+
+        uint64_t hist_total = 0;
+        for (auto count : after.histogram) hist_total += count;
+        REQUIRE(hist_total == after.allocations);
+    }
+
+    SECTION("counters of finished threads are kept") {
+        auto before = Tracked::stats();
+        TrackedVec kept{};
+        std::thread worker{[&kept] {
+            TrackedVec scratch(512, 1);
+            kept.assign(64, 2);
+        }};
+        worker.join();
+        auto after = Tracked::stats();
+        REQUIRE(after.live_bytes - before.live_bytes ==
+                static_cast<std::int64_t>(kept.capacity() * sizeof(size_t)));
+        REQUIRE(after.histogram[std::bit_width(512 * sizeof(size_t) - 1)] >
+                before.histogram[std::bit_width(512 * sizeof(size_t) - 1)]);
+    }
+
+    SECTION("peak holds when one thread allocates and another frees") {
+        struct handoff_tag {};
+        using HandoffVec = vector<size_t, my::tracking_allocator<my::allocator<size_t>, handoff_tag>>;
+        constexpr size_t rounds = 64;
+        size_t block_bytes = 0;
+        for (size_t r = 0; r < rounds; ++r) {
+            HandoffVec made{};
+            made.reserve(256);
+            block_bytes = made.capacity() * sizeof(size_t);
+            std::thread consumer{[&made] { made = HandoffVec{}; }};
+            consumer.join();
+        }
+        auto stats = HandoffVec::allocator_type::stats();
+        REQUIRE(stats.live_bytes == 0);
+        REQUIRE(stats.peak_bytes == block_bytes);
+    }
+}
+
+namespace {
+
+// Copies throw while armed, so that the element a growing insert
+// constructs in its new buffer can fail.
+struct throws_on_copy {
+    static inline bool armed = false;
+    int value;
+
+    explicit throws_on_copy(int v) : value{v} {}
+    throws_on_copy(const throws_on_copy& other) : value{other.value} {
+        if (armed) throw std::runtime_error("copy");
+    }
+    throws_on_copy(throws_on_copy&&) noexcept = default;
+    throws_on_copy& operator=(const throws_on_copy&) = default;
+    throws_on_copy& operator=(throws_on_copy&&) noexcept = default;
+};
+
+// Fills v to capacity, then makes every growing insert throw: each must
+// free the buffer it allocated and leave v as it was.
+template<class Vec>
+void check_growth_is_strong() {
+    using Tracked = typename Vec::allocator_type;
+    Vec v;
+    v.emplace_back(0);
+    while (v.size() < v.capacity()) {
+        v.emplace_back(static_cast<int>(v.size()));
+    }
+    auto values = [&] {
+        std::vector<int> out;
+        for (const auto& e : v) out.push_back(e.value);
+        return out;
+    };
+    const auto before = values();
+    const auto live_bytes = Tracked::stats().live_bytes;
+    const throws_on_copy extra{99};
+    const std::vector<throws_on_copy> more(v.capacity() + 1, extra);
+
+    auto fails_cleanly = [&](auto op) {
+        throws_on_copy::armed = true;
+        bool threw = false;
+        try {
+            op();
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        throws_on_copy::armed = false;
+        return threw && Tracked::stats().live_bytes == live_bytes && values() == before;
+    };
+    REQUIRE(fails_cleanly([&] { v.push_back(extra); }));
+    REQUIRE(fails_cleanly([&] { v.emplace_back(extra); }));
+    REQUIRE(fails_cleanly([&] { v.insert(v.begin() + 1, extra); }));
+    REQUIRE(fails_cleanly([&] { v.insert(v.begin() + 1, 3, extra); }));
+    REQUIRE(fails_cleanly([&] { v.insert(v.end(), more.begin(), more.end()); }));
+    REQUIRE(fails_cleanly([&] { v.assign(more.size(), extra); }));
+    REQUIRE(fails_cleanly([&] { v.assign(more.begin(), more.end()); }));
+}
+
+} // anonymous namespace
+
+TEST_CASE("my::vector does not leak when a growing insert throws", "[my::vector]") {
+    struct test_tag {};
+    using Tracked = my::tracking_allocator<my::allocator<throws_on_copy>, test_tag>;
+    check_growth_is_strong<vector<throws_on_copy, Tracked>>();
+    check_growth_is_strong<my::small_vector<throws_on_copy, 4, Tracked>>();
+}
+
+TEST_CASE("my::vector honours extended alignment", "[my::vector]") {
+    struct alignas(64) cache_line {
+        int value;
+    };
+    using Aligned = my::aligned_allocator<float, 64>;
+    static_assert(std::same_as<std::allocator_traits<Aligned>::rebind_alloc<double>,
+                               my::aligned_allocator<double, 64>>);
+    static_assert(my::aligned_allocator<cache_line, 16>::alignment == 64);
+
+    auto is_aligned = [](const void* p, size_t align) {
+        return reinterpret_cast<std::uintptr_t>(p) % align == 0;
+    };
+    constexpr size_t n = 1000;
+
+    SECTION("over-aligned element types") {
+        vector<cache_line> v{};
+        for (size_t i = 0; i < n; ++i) {
+            v.push_back(cache_line{static_cast<int>(i)});
+            REQUIRE(is_aligned(v.data(), 64));
+        }
+        v.shrink_to_fit();
+        REQUIRE(is_aligned(v.data(), 64));
+        REQUIRE(v.back().value == static_cast<int>(n - 1));
+
+        my::small_vector<cache_line, 2> sv(n, cache_line{7});
+        REQUIRE(is_aligned(sv.data(), 64));
+    }
+
+    SECTION("aligned buffers of a plain type") {
+        vector<float, Aligned> v(3, 1.0f);
+        REQUIRE(is_aligned(v.data(), 64));
+        for (size_t i = 0; i < n; ++i) {
+            v.push_back(static_cast<float>(i));
+            REQUIRE(is_aligned(v.data(), 64));
+        }
+        // capacity is padded to whole cache lines
+        v.reserve(v.size() + 1);
+        REQUIRE(v.capacity() * sizeof(float) % 64 == 0);
+    }
+
+    SECTION("oversized requests are rejected") {
+        my::allocator<cache_line> alloc{};
+        REQUIRE_THROWS_AS(alloc.allocate(alloc.max_size() + 1), std::bad_array_new_length);
+        REQUIRE_THROWS_AS(my::allocator<int>{}.allocate(std::numeric_limits<size_t>::max() / 2),
+                          std::bad_array_new_length);
+        REQUIRE_THROWS_AS(Aligned{}.allocate(Aligned{}.max_size() + 1), std::bad_array_new_length);
+    }
+}
+
+TEST_CASE("my::vector follows its growth policy", "[my::vector]") {
+    SECTION("growth factors") {
+        STATIC_REQUIRE(my::doubling_growth::grow(8, 9, 1) == 16);
+        STATIC_REQUIRE(my::one_and_half_growth::grow(8, 9, 1) == 12);
+        STATIC_REQUIRE(my::one_and_half_growth::grow(0, 1, 1) == 1);
+        STATIC_REQUIRE(my::doubling_growth::grow(8, 100, 1) == 100);
+        STATIC_REQUIRE(my::doubling_growth::grow(size_t(-1) / 2 + 1, 1, 1) == size_t(-1));
+
+        vector<int, my::allocator<int>, my::one_and_half_growth> vi{};
+        vi.reserve(8);
+        size_t cap = vi.capacity();
+        while (vi.size() <= cap) {
+            vi.push_back(1);
+        }
+        REQUIRE(vi.capacity() >= cap + cap / 2);
+        REQUIRE(vi.capacity() < 2 * cap);
+    }
+
+    SECTION("rounding policies") {
+        constexpr size_t mib = size_t{1} << 20;
+        using HugePage = my::huge_page_growth<>;
+        STATIC_REQUIRE(HugePage::grow(8, 9, 1) == 16);
+        STATIC_REQUIRE(HugePage::grow(3 * mib, 3 * mib + 1, 1) == 6 * mib);
+        STATIC_REQUIRE(HugePage::grow(mib + 1, mib + 2, 8) % (2 * mib / 8) == 0);
+
+        using SizeClass = my::size_class_growth<>;
+        constexpr size_t grown = SizeClass::grow(4, 5, 1);
+        STATIC_REQUIRE(grown >= 8);
+        STATIC_REQUIRE(my::malloc_size_class(grown) == grown);
+    }
+
+    SECTION("shrink on pop") {
+        vector<int, my::allocator<int>, my::shrink_on_pop<>> vi(1024, 7);
+        for (int i = 0; i < 1000; ++i) {
+            vi.pop_back();
+        }
+        REQUIRE(vi.size() == 24);
+        REQUIRE(vi.capacity() < 1024);
+        REQUIRE(vi.capacity() >= 2 * vi.size());
+        REQUIRE(vi.back() == 7);
+
+        size_t cap = vi.capacity();
+        vi.push_back(8);
+        vi.pop_back();
+        REQUIRE(vi.capacity() == cap);
+    }
+
+    SECTION("max_size derives from the allocator") {
+        REQUIRE(vector<char>{}.max_size() == size_t(std::numeric_limits<std::ptrdiff_t>::max()));
+        REQUIRE(VecStr{}.max_size() == std::numeric_limits<std::ptrdiff_t>::max() / sizeof(string));
+        VecInt vi{};
+        REQUIRE_THROWS_AS(vi.reserve(vi.max_size() + 1), std::length_error);
+    }
+}
+
+TEST_CASE("my::small_vector keeps small sizes inline", "[my::small_vector]") {
+    using SmallStr = my::small_vector<string, 4>;
+    constexpr size_t n = 4;
+
+    SmallStr sv{};
+    auto in_object = [](const SmallStr& v) {
+        auto p = reinterpret_cast<const std::byte*>(v.data());
+        auto self = reinterpret_cast<const std::byte*>(&v);
+        return p >= self && p < self + sizeof(v);
+    };
+
+    SECTION("no allocation up to N elements") {
+        REQUIRE(sv.capacity() == n);
+        for (size_t i = 0; i < n; ++i) {
+            sv.emplace_back(std::to_string(i));
+        }
+        REQUIRE(sv.is_inline());
+        REQUIRE(in_object(sv));
+        sv.push_back("spill");
+        REQUIRE_FALSE(sv.is_inline());
+        REQUIRE(sv.capacity() > n);
+        REQUIRE(sv[2] == "2");
+        REQUIRE(sv.back() == "spill");
+
+        sv.pop_back();
+        sv.shrink_to_fit();
+        REQUIRE(sv.is_inline());
+        REQUIRE(sv[3] == "3");
+    }
+
+    SECTION("moves relocate inline elements and steal heap buffers") {
+        SmallStr small(2, "foo");
+        SmallStr moved_small{std::move(small)};
+        REQUIRE(moved_small.is_inline());
+        REQUIRE(moved_small.size() == 2);
+        REQUIRE(moved_small[1] == "foo");
+        REQUIRE(small.empty());
+
+        SmallStr big(64, "bar");
+        const string* heap = big.data();
+        SmallStr moved_big{std::move(big)};
+        REQUIRE(moved_big.data() == heap);
+        REQUIRE(big.empty());
+        REQUIRE(big.is_inline());
+    }
+
+    SECTION("swap across inline and heap storage") {
+        SmallStr a(3, "a");
+        SmallStr b(1, "b");
+        SmallStr c(10, "c");
+        a.swap(b);
+        REQUIRE(a.size() == 1);
+        REQUIRE(b.size() == 3);
+        REQUIRE(a[0] == "b");
+        REQUIRE(b[2] == "a");
+        a.swap(c);
+        REQUIRE(a.size() == 10);
+        REQUIRE(c.size() == 1);
+        REQUIRE(c.is_inline());
+        REQUIRE(c[0] == "b");
+        REQUIRE(a[9] == "c");
+    }
+}